@@ -0,0 +1,629 @@
+/*
+ *  UEFI Tetris
+ *  Copyright (C) 2013C2014, Curtis McEnroe programble@gmail.com
+ *
+ *  Permission to use, copy, modify, and/or distribute this software
+ *  for any purpose with or without fee is hereby granted, provided 
+ *  that the above copyright notice and this permission notice
+ *  appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ *  WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL
+ *  THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR 
+ *  CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ *  LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ *  NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ *  CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "platform.h"
+#include "tetris.h"
+#include "ai.h"
+
+/* Weights found by Yiyuan Lee for the same four features */
+const struct weights default_weights = { -510, 761, -357, -184 };
+
+/* Bits of a row that are cells of the well rather than its walls */
+#define CELLS ((uint16_t) ~EMPTY_ROW)
+
+/* Number of bits set in n */
+static uint8_t bits(uint16_t n)
+{
+    n = n - ((n >> 1) & 0x5555);
+    n = (n & 0x3333) + ((n >> 2) & 0x3333);
+    n = (n + (n >> 4)) & 0x0F0F;
+    return (n + (n >> 8)) & 0x1F;
+}
+
+uint64_t board_hash(const struct board *b)
+{
+    uint64_t hash = 0;
+    uint8_t y;
+    for (y = 0; y < WELL_HEIGHT; y++)
+        hash ^= row_hash(y, b->rows[y]);
+    return hash;
+}
+
+/* Rows of the well that are full but not cleared yet are left out, so only
+ * the rows a placement fills can be full on a board. */
+void board_load(struct board *b, const struct tetris *t)
+{
+    int8_t from, to;
+
+    memcpy(b->rows, t->occupancy, sizeof(b->rows));
+    b->hash = t->hash;
+    if (t->cleared_rows[0] < 0)
+        return;
+    for (from = to = WELL_HEIGHT - 1; from >= 0; from--)
+        if (b->rows[from] != FULL_ROW)
+            b->rows[to--] = b->rows[from];
+    for (; to >= 0; to--)
+        b->rows[to] = EMPTY_ROW;
+    b->hash = board_hash(b);
+}
+
+void board_empty(struct board *b)
+{
+    uint8_t y;
+    for (y = 0; y < WELL_HEIGHT; y++)
+        b->rows[y] = EMPTY_ROW;
+    for (; y < WELL_HEIGHT + 4; y++)
+        b->rows[y] = FULL_ROW;
+    b->hash = 0;
+}
+
+/* Only the rows the tetrimino has cells in are looked at, so y can go as far
+ * down as the floor. */
+bool board_collide(const struct board *b, uint8_t i, uint8_t r, int8_t x,
+                   int8_t y)
+{
+    int8_t row;
+    for (row = TETRIS_BOX[i][r].top; row <= TETRIS_BOX[i][r].bottom; row++)
+        if (b->rows[y + row] & TETRIS_MASK[i][r][row] << (x + WALL))
+            return true;
+    return false;
+}
+
+uint8_t board_place(struct board *b, uint8_t i, uint8_t r, int8_t x, int8_t y)
+{
+    uint8_t row, lines = 0;
+    int8_t from, to;
+    uint16_t before;
+
+    for (row = TETRIS_BOX[i][r].top; row <= TETRIS_BOX[i][r].bottom; row++) {
+        before = b->rows[y + row];
+        b->rows[y + row] |= TETRIS_MASK[i][r][row] << (x + WALL);
+        b->hash ^= row_hash(y + row, before) ^
+                   row_hash(y + row, b->rows[y + row]);
+        lines += b->rows[y + row] == FULL_ROW;
+    }
+    if (!lines)
+        return 0;
+
+    /* Compact the rows above the bottom of the tetrimino, skipping full
+     * ones, like clear_rows(). Every one of them may move, so they are taken
+     * out of the hash first and put back after. */
+    from = to = y + 3 < WELL_HEIGHT ? y + 3 : WELL_HEIGHT - 1;
+    for (row = 0; row <= from; row++)
+        b->hash ^= row_hash(row, b->rows[row]);
+    for (; from >= 0; from--) {
+        if (b->rows[from] == FULL_ROW)
+            continue;
+        b->rows[to--] = b->rows[from];
+    }
+    for (; to >= 0; to--)
+        b->rows[to] = EMPTY_ROW;
+    for (row = 0; row <= y + 3 && row < WELL_HEIGHT; row++)
+        b->hash ^= row_hash(row, b->rows[row]);
+    return lines;
+}
+
+int32_t board_evaluate(const struct board *b, uint8_t lines,
+                       const struct weights *w)
+{
+    uint8_t height[WELL_WIDTH] = {0}, x, y;
+    uint16_t covered = 0, row, first;
+    int32_t aggregate = 0, holes = 0, bumpiness = 0, d;
+
+    /* Going down the well: a column's height is set by the first cell found
+     * in it, and every empty cell under a covered column is a hole. */
+    for (y = 0; y < WELL_HEIGHT; y++) {
+        row = b->rows[y] & CELLS;
+        if ((first = row & ~covered))
+            for (x = 0; x < WELL_WIDTH; x++)
+                if (first & 1 << (x + WALL))
+                    height[x] = WELL_HEIGHT - y;
+        holes += bits(covered & ~row);
+        covered |= row;
+    }
+    for (x = 0; x < WELL_WIDTH; x++) {
+        aggregate += height[x];
+        if (x) {
+            d = height[x] - height[x - 1];
+            bumpiness += d < 0 ? -d : d;
+        }
+    }
+    return w->height * aggregate + w->lines * lines + w->holes * holes +
+           w->bumpiness * bumpiness;
+}
+
+/* Return the row tetrimino i in rotation r at x lands on when dropped from
+ * row y, where it must not collide. */
+static int8_t board_drop(const struct board *b, uint8_t i, uint8_t r, int8_t x,
+                         int8_t y)
+{
+    while (!board_collide(b, i, r, x, y + 1))
+        y++;
+    return y;
+}
+
+/* Batch evaluation */
+
+const char *const evaluator_names[EVALUATOR__LENGTH] = {
+    "scalar", "sse2", "avx2"
+};
+
+enum evaluator evaluator = EVALUATOR_SCALAR;
+
+/* Pairs of neighbouring columns, by the bit of the left one */
+#define PAIRS ((uint16_t) (CELLS & CELLS >> 1))
+
+/* bits() of n, a variable holding one row or a vector of them, which it
+ * overwrites */
+#define BITS(n) ((n) = (n) - ((n) >> 1 & 0x5555), \
+                 (n) = ((n) & 0x3333) + ((n) >> 2 & 0x3333), \
+                 (n) = ((n) + ((n) >> 4)) & 0x0F0F, \
+                 ((n) + ((n) >> 8)) & 0x1F)
+
+/* Add row y to the features of board_evaluate(), going down the well, for
+ * one board or a vector of them. covered has the columns with a cell at or
+ * above the row. A column's height is the number of rows it is covered in,
+ * and since covered only gains columns going down, two neighbouring columns
+ * differ in height by the number of rows only one of them is covered in. So
+ * each feature is a sum of bit counts, one per row, with no per-column work
+ * to do. */
+#define FEATURES_ROW(row, covered, n, aggregate, holes, bumpiness) do { \
+        (row) &= CELLS;                                                \
+        (n) = (covered) & ~(row);                                      \
+        (holes) += BITS(n);                                            \
+        (covered) |= (row);                                            \
+        (n) = (covered);                                               \
+        (aggregate) += BITS(n);                                        \
+        (n) = ((covered) ^ (covered) >> 1) & PAIRS;                    \
+        (bumpiness) += BITS(n);                                        \
+    } while (0)
+
+/* Features of each board of a batch. The rows above the top one add nothing
+ * to them and are skipped. */
+struct features {
+    uint16_t aggregate[BATCH] __attribute__((aligned(32)));
+    uint16_t holes[BATCH] __attribute__((aligned(32)));
+    uint16_t bumpiness[BATCH] __attribute__((aligned(32)));
+};
+
+static void features_scalar(const struct batch *batch, struct features *f)
+{
+    uint16_t covered, row, n, aggregate, holes, bumpiness;
+    uint8_t k, y;
+
+    for (k = 0; k < batch->length; k++) {
+        covered = aggregate = holes = bumpiness = 0;
+        for (y = batch->top; y < WELL_HEIGHT; y++) {
+            row = batch->rows[y][k];
+            FEATURES_ROW(row, covered, n, aggregate, holes, bumpiness);
+        }
+        f->aggregate[k] = aggregate;
+        f->holes[k] = holes;
+        f->bumpiness[k] = bumpiness;
+    }
+}
+
+/* The vector versions work on every board of the batch, in use or not, and
+ * are compiled for their instruction set whatever the rest of the program
+ * is compiled for; they are only called if the processor has it. */
+#if defined(__x86_64__) || defined(__i386__)
+
+typedef uint16_t vector8 __attribute__((vector_size(16)));
+typedef uint16_t vector16 __attribute__((vector_size(32)));
+
+__attribute__((target("sse2")))
+static void features_sse2(const struct batch *batch, struct features *f)
+{
+    vector8 covered, row, n, aggregate, holes, bumpiness;
+    uint8_t k, y;
+
+    for (k = 0; k < BATCH; k += 8) {
+        covered = aggregate = holes = bumpiness = (vector8) {0};
+        for (y = batch->top; y < WELL_HEIGHT; y++) {
+            row = *(const vector8 *) &batch->rows[y][k];
+            FEATURES_ROW(row, covered, n, aggregate, holes, bumpiness);
+        }
+        *(vector8 *) &f->aggregate[k] = aggregate;
+        *(vector8 *) &f->holes[k] = holes;
+        *(vector8 *) &f->bumpiness[k] = bumpiness;
+    }
+}
+
+__attribute__((target("avx2")))
+static void features_avx2(const struct batch *batch, struct features *f)
+{
+    vector16 covered = {0}, row, n, aggregate = {0}, holes = {0},
+             bumpiness = {0};
+    uint8_t y;
+
+    for (y = batch->top; y < WELL_HEIGHT; y++) {
+        row = *(const vector16 *) batch->rows[y];
+        FEATURES_ROW(row, covered, n, aggregate, holes, bumpiness);
+    }
+    *(vector16 *) f->aggregate = aggregate;
+    *(vector16 *) f->holes = holes;
+    *(vector16 *) f->bumpiness = bumpiness;
+}
+
+static void cpuid(uint32_t leaf, uint32_t regs[4])
+{
+    asm volatile ("cpuid"
+                  : "=a" (regs[0]), "=b" (regs[1]), "=c" (regs[2]),
+                    "=d" (regs[3])
+                  : "a" (leaf), "c" (0));
+}
+
+bool evaluator_supported(enum evaluator e)
+{
+    uint32_t regs[4], max, lo, hi;
+
+    cpuid(0, regs);
+    max = regs[0];
+    cpuid(1, regs);
+    switch (e) {
+    case EVALUATOR_SCALAR:
+        return true;
+    case EVALUATOR_SSE2:
+        return regs[3] & 1 << 26;
+    case EVALUATOR_AVX2:
+        /* The firmware or operating system must have turned on saving of
+         * the AVX registers (OSXSAVE, and XCR0 bits 1 and 2), which UEFI
+         * firmware does not always do. */
+        if (max < 7 || !(regs[2] & 1 << 27) || !(regs[2] & 1 << 28))
+            return false;
+        asm volatile ("xgetbv" : "=a" (lo), "=d" (hi) : "c" (0));
+        if ((lo & 6) != 6)
+            return false;
+        cpuid(7, regs);
+        return regs[1] & 1 << 5;
+    default:
+        return false;
+    }
+}
+
+#else
+
+bool evaluator_supported(enum evaluator e)
+{
+    return e == EVALUATOR_SCALAR;
+}
+
+#endif
+
+enum evaluator evaluator_fastest(void)
+{
+    enum evaluator e = EVALUATOR__LENGTH - 1;
+    while (!evaluator_supported(e))
+        e--;
+    return e;
+}
+
+void batch_add(struct batch *batch, const struct board *b, uint8_t lines)
+{
+    uint8_t y;
+
+    if (!batch->length)
+        batch->top = WELL_HEIGHT;
+    for (y = 0; y < WELL_HEIGHT; y++) {
+        batch->rows[y][batch->length] = b->rows[y];
+        if (y < batch->top && b->rows[y] != EMPTY_ROW)
+            batch->top = y;
+    }
+    batch->lines[batch->length++] = lines;
+}
+
+/* Set scores as batch_evaluate() does, with the evaluator e */
+static void evaluate(enum evaluator e, const struct batch *batch,
+                     const struct weights *w, int32_t *scores)
+{
+    struct features f;
+    uint8_t k;
+
+    switch (e) {
+#if defined(__x86_64__) || defined(__i386__)
+    case EVALUATOR_AVX2:
+        features_avx2(batch, &f);
+        break;
+    case EVALUATOR_SSE2:
+        features_sse2(batch, &f);
+        break;
+#endif
+    default:
+        features_scalar(batch, &f);
+    }
+    for (k = 0; k < batch->length; k++)
+        scores[k] = w->height * f.aggregate[k] + w->lines * batch->lines[k] +
+                    w->holes * f.holes[k] + w->bumpiness * f.bumpiness[k];
+}
+
+void batch_evaluate(const struct batch *batch, const struct weights *w,
+                    int32_t *scores)
+{
+    evaluate(evaluator, batch, w, scores);
+}
+
+/* Transposition table */
+
+/* Data of an entry: the score in the low 32 bits, and flags above. No
+ * entry has data 0, which marks a free slot. */
+#define ENTRY_USED  (1ULL << 32)
+#define ENTRY_FOUND (1ULL << 33) /* A placement was found */
+
+bool table_init(struct table *t)
+{
+    memset(t, 0, sizeof(*t));
+    t->entries = allocate(TABLE_SIZE * sizeof(*t->entries));
+    if (!t->entries)
+        return false;
+    memset(t->entries, 0, TABLE_SIZE * sizeof(*t->entries));
+    return true;
+}
+
+/* The words of an entry are read and written whole, but in no particular
+ * order with respect to other processors. */
+static bool table_get(struct table *t, uint64_t key, uint64_t *data)
+{
+    struct table_entry *e;
+    uint64_t check;
+    uint32_t n;
+
+    for (n = 0; n < TABLE_PROBE; n++) {
+        e = &t->entries[(key + n) & (TABLE_SIZE - 1)];
+        *data = __atomic_load_n(&e->data, __ATOMIC_RELAXED);
+        check = __atomic_load_n(&e->check, __ATOMIC_RELAXED);
+        if (!*data)
+            return false;
+        if ((check ^ *data) == key)
+            return true;
+    }
+    return false;
+}
+
+static void table_put(struct table *t, uint64_t key, uint64_t data)
+{
+    struct table_entry *e = &t->entries[key & (TABLE_SIZE - 1)];
+    uint64_t used;
+    uint32_t n;
+
+    for (n = 0; n < TABLE_PROBE; n++) {
+        used = __atomic_load_n(
+            &t->entries[(key + n) & (TABLE_SIZE - 1)].data, __ATOMIC_RELAXED);
+        if (!used) {
+            e = &t->entries[(key + n) & (TABLE_SIZE - 1)];
+            break;
+        }
+    }
+    __atomic_store_n(&e->data, data, __ATOMIC_RELAXED);
+    __atomic_store_n(&e->check, key ^ data, __ATOMIC_RELAXED);
+}
+
+/* Lookups and hits of one search, added to the table's once it is over */
+struct counts {
+    uint32_t lookups, hits;
+};
+
+/* Every rotation and column of a tetrimino, numbered
+ * r * (WELL_WIDTH + WALL) + x + WALL */
+#define PLACEMENTS (4 * (WELL_WIDTH + WALL))
+
+/* The boards of a search waiting to be evaluated, and the placements they
+ * come from */
+struct pending {
+    struct batch batch;
+    uint8_t placement[BATCH];
+    uint64_t hash[BATCH];
+};
+
+/* Evaluate the boards of p with e into score, by placement, and put them in
+ * table if not NULL. Scores are kept in the table without the lines, which
+ * are not part of the well. */
+static void flush(struct pending *p, enum evaluator e,
+                  const struct weights *w, struct table *table,
+                  int32_t *score)
+{
+    int32_t scores[BATCH];
+    uint8_t k;
+
+    evaluate(e, &p->batch, w, scores);
+    for (k = 0; k < p->batch.length; k++) {
+        score[p->placement[k]] = scores[k];
+        if (table)
+            table_put(table, p->hash[k], ENTRY_USED |
+                      (uint32_t) (scores[k] - w->lines * p->batch.lines[k]));
+    }
+    p->batch.length = 0;
+}
+
+/* Boards are evaluated a batch at a time, with e, so the scores are collected
+ * by placement and the best one is picked in order once they are all in. */
+static bool search(const struct board *b, uint8_t i, int8_t y,
+                   enum evaluator e, const struct weights *w,
+                   struct table *table, struct counts *counts,
+                   struct placement *best)
+{
+    struct pending pending;
+    struct board after;
+    int8_t landing[PLACEMENTS];
+    int32_t score[PLACEMENTS];
+    bool valid[PLACEMENTS], found = false;
+    uint64_t data;
+    uint8_t n, r, lines;
+    int8_t x;
+
+    pending.batch.length = 0;
+    for (n = 0; n < PLACEMENTS; n++) {
+        r = n / (WELL_WIDTH + WALL);
+        x = n % (WELL_WIDTH + WALL) - WALL;
+        valid[n] = !board_collide(b, i, r, x, y);
+        if (!valid[n])
+            continue;
+        landing[n] = board_drop(b, i, r, x, y);
+        after = *b;
+        lines = board_place(&after, i, r, x, landing[n]);
+        if (table) {
+            counts->lookups++;
+            if (table_get(table, after.hash, &data)) {
+                counts->hits++;
+                score[n] = (int32_t) (uint32_t) data + w->lines * lines;
+                continue;
+            }
+        }
+        pending.placement[pending.batch.length] = n;
+        pending.hash[pending.batch.length] = after.hash;
+        batch_add(&pending.batch, &after, lines);
+        if (pending.batch.length == BATCH)
+            flush(&pending, e, w, table, score);
+    }
+    flush(&pending, e, w, table, score);
+
+    for (n = 0; n < PLACEMENTS; n++)
+        if (valid[n] && (!found || score[n] > best->score)) {
+            found = true;
+            best->r = n / (WELL_WIDTH + WALL);
+            best->x = n % (WELL_WIDTH + WALL) - WALL;
+            best->y = landing[n];
+            best->score = score[n];
+        }
+    return found;
+}
+
+bool ai_search(const struct board *b, uint8_t i, int8_t y,
+               const struct weights *w, struct placement *best)
+{
+    return search(b, i, y, evaluator, w, NULL, NULL, best);
+}
+
+/* Lookahead */
+
+/* Each placement of the first tetrimino is a task. Processors take the next
+ * task from a shared counter until there are none left, and write the best
+ * score after the second tetrimino to that task's slot, so the result does
+ * not depend on which processor did which task. */
+#define TASKS PLACEMENTS
+
+struct lookahead {
+    const struct board *b;
+    const struct weights *w;
+    enum evaluator evaluator;
+    struct table *table;
+    uint8_t i, next;
+    int8_t y;
+    volatile uint32_t task;
+    bool found[TASKS];
+    int8_t landing[TASKS];
+    int32_t score[TASKS];
+    struct counts counts[TASKS];
+};
+
+/* The best placement of the next tetrimino on a well is kept in the table
+ * under the hash of the well and the tetrimino together. The evaluator was
+ * picked on the processor that started the search; any other one may lack
+ * its instructions, or not have them turned on, so each falls back to the
+ * fastest one it can run. The scores are the same whichever it is. */
+static void lookahead_work(void *arg)
+{
+    struct lookahead *l = arg;
+    enum evaluator e = l->evaluator;
+    struct placement second;
+    struct counts *counts;
+    struct board after;
+    uint64_t key, data;
+    uint32_t task;
+    uint8_t r, lines;
+    int8_t x;
+
+    while (!evaluator_supported(e))
+        e--;
+
+    while ((task = __sync_fetch_and_add(&l->task, 1)) < TASKS) {
+        r = task / (WELL_WIDTH + WALL);
+        x = task % (WELL_WIDTH + WALL) - WALL;
+        counts = &l->counts[task];
+        counts->lookups = counts->hits = 0;
+        l->found[task] = false;
+        if (board_collide(l->b, l->i, r, x, l->y))
+            continue;
+        l->landing[task] = board_drop(l->b, l->i, r, x, l->y);
+        after = *l->b;
+        lines = board_place(&after, l->i, r, x, l->landing[task]);
+
+        key = after.hash ^ ZOBRIST_PIECE[l->next];
+        if (l->table)
+            counts->lookups++;
+        if (l->table && table_get(l->table, key, &data))
+            counts->hits++;
+        else {
+            data = ENTRY_USED;
+            if (search(&after, l->next, 0, e, l->w, l->table, counts,
+                       &second))
+                data |= ENTRY_FOUND | (uint32_t) second.score;
+            if (l->table)
+                table_put(l->table, key, data);
+        }
+        /* A placement that leaves no room for the next tetrimino loses */
+        if (!(data & ENTRY_FOUND))
+            continue;
+        l->found[task] = true;
+        l->score[task] = (int32_t) (uint32_t) data + l->w->lines * lines;
+    }
+}
+
+bool ai_lookahead(const struct board *b, uint8_t i, uint8_t next, int8_t y,
+                  const struct weights *w, bool all_processors,
+                  struct table *table, struct placement *best)
+{
+    struct lookahead l;
+    bool found = false;
+    uint32_t task;
+
+    /* Entries found with other weights are no use */
+    if (table && memcmp(&table->w, w, sizeof(*w))) {
+        memset(table->entries, 0, TABLE_SIZE * sizeof(*table->entries));
+        table->w = *w;
+    }
+    l.b = b;
+    l.w = w;
+    l.evaluator = evaluator;
+    l.table = table;
+    l.i = i;
+    l.next = next;
+    l.y = y;
+    l.task = 0;
+    if (all_processors)
+        parallel(lookahead_work, &l);
+    else
+        lookahead_work(&l);
+    __sync_synchronize();
+
+    for (task = 0; task < TASKS; task++) {
+        if (table) {
+            table->lookups += l.counts[task].lookups;
+            table->hits += l.counts[task].hits;
+        }
+        if (l.found[task] && (!found || l.score[task] > best->score)) {
+            found = true;
+            best->r = task / (WELL_WIDTH + WALL);
+            best->x = task % (WELL_WIDTH + WALL) - WALL;
+            best->y = l.landing[task];
+            best->score = l.score[task];
+        }
+    }
+    /* Every placement loses: take the best one for this tetrimino alone */
+    return found || ai_search(b, i, y, w, best);
+}
@@ -0,0 +1,159 @@
+/*
+ *  UEFI Tetris
+ *  Copyright (C) 2013C2014, Curtis McEnroe programble@gmail.com
+ *
+ *  Permission to use, copy, modify, and/or distribute this software
+ *  for any purpose with or without fee is hereby granted, provided 
+ *  that the above copyright notice and this permission notice
+ *  appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ *  WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL
+ *  THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR 
+ *  CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ *  LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ *  NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ *  CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef AI_H
+#define AI_H
+
+#include "platform.h"
+#include "tetris.h"
+
+/* Autoplayer: tries every rotation and column of a tetrimino on a copy of the
+ * well, drops it and scores the result with a weighted sum of features of the
+ * surface. */
+
+/* A well as far as the search is concerned: its occupancy bitboard, in the
+ * same layout as in struct tetris. Boards are plain values, so any number of
+ * them can be searched at once. */
+struct board {
+    uint16_t rows[WELL_HEIGHT + 4];
+    uint64_t hash; /* Zobrist hash of rows, kept up to date by board_place() */
+};
+
+/* Weights of the features, in thousandths: the sum of the column heights,
+ * the number of rows cleared, the number of empty cells with a filled cell
+ * somewhere above them, and the sum of the height differences of
+ * neighbouring columns. */
+struct weights {
+    int32_t height, lines, holes, bumpiness;
+};
+
+extern const struct weights default_weights;
+
+/* Where to put a tetrimino, and its score */
+struct placement {
+    uint8_t r;
+    int8_t x, y;
+    int32_t score;
+};
+
+/* Copy the well of t into b, as it will be once its full rows are cleared. */
+void board_load(struct board *b, const struct tetris *t);
+
+/* Make b an empty well. */
+void board_empty(struct board *b);
+
+/* Return true if tetrimino i in rotation r at x, y overlaps anything on b. */
+bool board_collide(const struct board *b, uint8_t i, uint8_t r, int8_t x,
+                   int8_t y);
+
+/* Lock tetrimino i in rotation r at x, y into b, remove the rows it fills and
+ * return how many there were. */
+uint8_t board_place(struct board *b, uint8_t i, uint8_t r, int8_t x, int8_t y);
+
+/* Score b after a placement that cleared lines rows. Higher is better. */
+int32_t board_evaluate(const struct board *b, uint8_t lines,
+                       const struct weights *w);
+
+/* Batch evaluation: board_evaluate() of up to BATCH boards at once, with
+ * vector instructions where the processor has them. The boards are kept
+ * struct-of-arrays, row y of board k in rows[y][k], so that a vector holds
+ * the same row of every board. Only the rows of the well itself are kept. */
+#define BATCH (16)
+
+struct batch {
+    uint16_t rows[WELL_HEIGHT][BATCH] __attribute__((aligned(32)));
+    uint8_t lines[BATCH]; /* Rows cleared by the placement of each board */
+    uint8_t length;       /* Boards in use */
+    uint8_t top;          /* First row with a cell in any of them */
+};
+
+/* Ways of evaluating a batch. They all give the same scores. */
+enum evaluator {
+    EVALUATOR_SCALAR, /* One board at a time */
+    EVALUATOR_SSE2,   /* 8 boards per instruction */
+    EVALUATOR_AVX2,   /* 16 boards per instruction */
+    EVALUATOR__LENGTH
+};
+
+extern const char *const evaluator_names[EVALUATOR__LENGTH];
+
+/* The evaluator batch_evaluate() and searches use: EVALUATOR_SCALAR until it
+ * is set, usually to evaluator_fastest(). Other processors of a parallel
+ * lookahead use a slower one if they cannot run it. */
+extern enum evaluator evaluator;
+
+/* Return true if the calling processor can run e. */
+bool evaluator_supported(enum evaluator e);
+
+/* Return the fastest evaluator the processor can run. */
+enum evaluator evaluator_fastest(void);
+
+/* Add b, after a placement that cleared lines rows, to batch, which must not
+ * be full. */
+void batch_add(struct batch *batch, const struct board *b, uint8_t lines);
+
+/* Set scores[k] to the score of board k of batch, for every board in it. */
+void batch_evaluate(const struct batch *batch, const struct weights *w,
+                    int32_t *scores);
+
+/* Find the best placement on b of tetrimino i, coming down from row y. Return
+ * false if it fits nowhere. */
+bool ai_search(const struct board *b, uint8_t i, int8_t y,
+               const struct weights *w, struct placement *best);
+
+/* Return the Zobrist hash of b worked out from scratch. */
+uint64_t board_hash(const struct board *b);
+
+/* Transposition table: what the lookahead found for the wells it has already
+ * searched, keyed by Zobrist hash, so a well reached again, by another order
+ * of moves or in the search for the next tetrimino, is not searched again.
+ * It has a fixed size and is open-addressed: an entry goes in the first free
+ * slot of the TABLE_PROBE slots from its hash, or over the first of them if
+ * none is free. The processors of a parallel search share it without locks;
+ * each entry is stored with its key XORed with its data, so an entry torn by
+ * two processors writing it at once does not match and reads as a miss. */
+#define TABLE_BITS  (16)
+#define TABLE_SIZE  (1 << TABLE_BITS)
+#define TABLE_PROBE (4)
+
+struct table_entry {
+    uint64_t check, data;
+};
+
+struct table {
+    struct table_entry *entries; /* TABLE_SIZE of them */
+    struct weights w;            /* The weights the entries were found with */
+    uint64_t lookups, hits;
+};
+
+/* Allocate the entries of t, once for the life of the program. Return false
+ * if there is not enough memory. */
+bool table_init(struct table *t);
+
+/* Find the placement of tetrimino i that leaves the best placement for next,
+ * the preview tetrimino, which will come down from the top. The score is that
+ * of the well after both. The placements of i are shared out between the
+ * processors with parallel() if all_processors is set; the result is the same
+ * either way. Wells already in table, if not NULL, are not searched again;
+ * that does not change the result either. */
+bool ai_lookahead(const struct board *b, uint8_t i, uint8_t next, int8_t y,
+                  const struct weights *w, bool all_processors,
+                  struct table *table, struct placement *best);
+
+#endif
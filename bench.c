@@ -0,0 +1,567 @@
+/*
+ *  UEFI Tetris
+ *  Copyright (C) 2013C2014, Curtis McEnroe programble@gmail.com
+ *
+ *  Permission to use, copy, modify, and/or distribute this software
+ *  for any purpose with or without fee is hereby granted, provided 
+ *  that the above copyright notice and this permission notice
+ *  appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ *  WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL
+ *  THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR 
+ *  CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ *  LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ *  NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ *  CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "tetris.h"
+#include "ai.h"
+
+/* Benchmarks of engine internals, run instead of the game with tetris-host -b
+ * or the "bench" load option of tetris.efi. Results are printed as one line
+ * per benchmark. */
+
+/* Pseudo-random numbers for generating test wells: a fixed-seed xorshift, so
+ * every run measures the same wells. */
+static uint32_t bench_seed = 2463534242U;
+
+static uint32_t bench_rand(uint32_t range)
+{
+    bench_seed ^= bench_seed << 13;
+    bench_seed ^= bench_seed >> 17;
+    bench_seed ^= bench_seed << 5;
+    return bench_seed % range;
+}
+
+/* Format n in decimal. */
+static const char *num(uint64_t n)
+{
+    static char s[21];
+    uint8_t i = 20;
+    s[i] = 0;
+    do {
+        s[--i] = '0' + n % 10;
+        n /= 10;
+    } while (n);
+    return s + i;
+}
+
+/* Append s to the line being built up in line. */
+static void cat(char *line, const char *s)
+{
+    while (*line)
+        line++;
+    while ((*line++ = *s++))
+        ;
+}
+
+/* Return the number of nanoseconds per iteration of n iterations taking t
+ * ticks, in hundredths. */
+static uint64_t ns(uint64_t t, uint64_t n)
+{
+    return t * 100000000 / tpms / n;
+}
+
+/* Append n hundredths with two decimals. */
+static void cat_hundredths(char *line, uint64_t n)
+{
+    cat(line, num(n / 100));
+    cat(line, ".");
+    cat(line, num(n / 10 % 10));
+    cat(line, num(n % 10));
+}
+
+/* Clear rows the way clear_rows() did before it compacted in a single pass:
+ * shift everything above each cleared row down by one, one cell at a time. */
+static void clear_rows_shift(struct tetris *t)
+{
+    int8_t i, y, x;
+    for (i = 0; i < 4; i++) {
+        if (t->cleared_rows[i] < 0)
+            break;
+        for (y = t->cleared_rows[i]; y > 0; y--) {
+            for (x = 0; x < WELL_WIDTH; x++)
+                t->well[y][x] = t->well[y - 1][x];
+            t->occupancy[y] = t->occupancy[y - 1];
+        }
+        t->cleared_rows[i] = -1;
+    }
+    for (x = 0; x < WELL_WIDTH; x++)
+        while (t->tops[x] < WELL_HEIGHT && !t->well[t->tops[x]][x])
+            t->tops[x]++;
+}
+
+#define BENCH_WELLS  (256)
+#define BENCH_ROUNDS (200)
+
+/* Games whose well is randomized: a stack of random height with random holes
+ * and one to four full rows somewhere in it. Nothing else of them is set. */
+static struct tetris wells[BENCH_WELLS];
+
+/* The game the benchmarks play */
+static struct tetris bench_game;
+
+static void bench_generate(struct tetris *w)
+{
+    uint8_t x, y, n, i, full[WELL_HEIGHT];
+    uint8_t height = 4 + bench_rand(WELL_HEIGHT - 4);
+
+    memset(w, 0, sizeof(*w));
+    memset(full, 0, sizeof(full));
+    for (n = 1 + bench_rand(4), i = 0; i < n; i++)
+        full[WELL_HEIGHT - 1 - bench_rand(height)] = 1;
+    for (y = 0; y < WELL_HEIGHT + 4; y++)
+        w->occupancy[y] = y < WELL_HEIGHT ? EMPTY_ROW : FULL_ROW;
+    memset(w->tops, WELL_HEIGHT, sizeof(w->tops));
+    memset(w->cleared_rows, -1, sizeof(w->cleared_rows));
+    for (i = 0, y = WELL_HEIGHT - height; y < WELL_HEIGHT; y++) {
+        for (x = 0; x < WELL_WIDTH; x++)
+            if (full[y] || bench_rand(4)) {
+                w->well[y][x] = 1 + bench_rand(7);
+                w->occupancy[y] |= 1 << (x + WALL);
+                if (y < w->tops[x])
+                    w->tops[x] = y;
+            }
+        if (full[y])
+            w->cleared_rows[i++] = y;
+    }
+}
+
+/* Time n clears of every well with clear, minus the time spent copying the
+ * wells. */
+static uint64_t bench_time(void (*clear)(struct tetris *t))
+{
+    uint64_t t0, t1, t2;
+    uint32_t r, i;
+
+    t0 = ticks();
+    for (r = 0; r < BENCH_ROUNDS; r++)
+        for (i = 0; i < BENCH_WELLS; i++)
+            bench_game = wells[i];
+    t1 = ticks();
+    for (r = 0; r < BENCH_ROUNDS; r++)
+        for (i = 0; i < BENCH_WELLS; i++) {
+            bench_game = wells[i];
+            clear(&bench_game);
+        }
+    t2 = ticks();
+    return t2 - t1 > t1 - t0 ? (t2 - t1) - (t1 - t0) : 0;
+}
+
+/* Compare clear_rows() against the cell-by-cell shifting it replaced, on the
+ * same randomized wells, after checking that both give the same result. */
+static void bench_clear(void)
+{
+    struct tetris shifted, compacted;
+    uint64_t shift, compact;
+    uint32_t i, errors = 0;
+    char line[128] = "";
+
+    for (i = 0; i < BENCH_WELLS; i++)
+        bench_generate(&wells[i]);
+
+    for (i = 0; i < BENCH_WELLS; i++) {
+        shifted = compacted = wells[i];
+        clear_rows_shift(&shifted);
+        clear_rows(&compacted);
+        if (memcmp(shifted.well, compacted.well, sizeof(shifted.well)) ||
+            memcmp(shifted.occupancy, compacted.occupancy,
+                   sizeof(shifted.occupancy)))
+            errors++;
+    }
+
+    shift = bench_time(clear_rows_shift);
+    compact = bench_time(clear_rows);
+
+    cat(line, "clear_rows: shift ");
+    cat_hundredths(line, ns(shift, BENCH_ROUNDS * BENCH_WELLS));
+    cat(line, " ns, compact ");
+    cat_hundredths(line, ns(compact, BENCH_ROUNDS * BENCH_WELLS));
+    cat(line, " ns, speedup ");
+    cat_hundredths(line, compact ? shift * 100 / compact : 0);
+    cat(line, "x, mismatches ");
+    cat(line, num(errors));
+    print(line);
+}
+
+/* Headless games: the engine driven as fast as it goes by a policy that
+ * places each tetrimino, with no drawing, no sound and no clock. Gravity
+ * never comes into it; every tetrimino is hard dropped and full rows are
+ * cleared right away. Each game starts from the next seed, so every run
+ * plays the same games. */
+#define SIM_PIECES (200000)
+
+static struct rng sim_rng;
+
+/* Rotate the current tetrimino and move it sideways at random. */
+static void sim_random(struct tetris *t)
+{
+    uint32_t r = rng_range(&sim_rng, 4);
+    int8_t x = rng_range(&sim_rng, WELL_WIDTH) - 1;
+    while (r--)
+        rotate(t);
+    while (t->current.x > x && move(t, -1, 0))
+        ;
+    while (t->current.x < x && move(t, 1, 0))
+        ;
+}
+
+/* Put the current tetrimino where its lowest cell lands deepest, leftmost
+ * first. Placements are tried at the spawn row and the tetrimino is put
+ * straight there. */
+static void sim_lowest(struct tetris *t)
+{
+    struct current start = t->current, best = t->current;
+    int8_t x, y, depth, best_depth = -1;
+    uint8_t r;
+
+    for (r = 0; r < 4; r++) {
+        y = TETRIS_BOX[start.i][r].bottom;
+        for (x = -WALL; x < WELL_WIDTH; x++) {
+            if (collide(t, start.i, r, x, start.y))
+                continue;
+            t->current.r = r;
+            t->current.x = x;
+            ghost(t);
+            depth = t->current.g + y;
+            if (depth > best_depth) {
+                best_depth = depth;
+                best = t->current;
+            }
+        }
+    }
+    t->current = best;
+}
+
+/* Place it where the autoplayer would */
+static void sim_ai(struct tetris *t)
+{
+    struct board board;
+    struct placement target;
+
+    board_load(&board, t);
+    if (!ai_search(&board, t->current.i, t->current.y, &default_weights,
+                   &target))
+        return;
+    t->current.r = target.r;
+    t->current.x = target.x;
+}
+
+static void bench_sim(const char *name, void (*policy)(struct tetris *t))
+{
+    struct tetris *game = &bench_game;
+    uint64_t t, pieces = 0, lines = 0, games = 0;
+    uint32_t game_seed = 1;
+    char line[160] = "";
+    uint8_t i;
+
+    rng_seed(&sim_rng, 1);
+    reset(game, game_seed, 0);
+    t = ticks();
+    while (pieces < SIM_PIECES) {
+        policy(game);
+        drop(game);
+        pieces++;
+        for (i = 0; i < 4; i++)
+            lines += game->cleared_rows[i] >= 0;
+        if (game->cleared_rows[0] >= 0)
+            clear_rows(game);
+        if (game->game_over) {
+            games++;
+            reset(game, ++game_seed, 0);
+        }
+    }
+    t = ticks() - t;
+
+    cat(line, "sim ");
+    cat(line, name);
+    cat(line, ": ");
+    cat(line, num(pieces * 1000 * tpms / t));
+    cat(line, " pieces/s, ");
+    cat(line, num(lines * 1000 * tpms / t));
+    cat(line, " lines/s, ");
+    cat(line, num(games * 1000 * tpms / t));
+    cat(line, " games/s (");
+    cat(line, num(pieces));
+    cat(line, " pieces, ");
+    cat(line, num(lines));
+    cat(line, " lines, ");
+    cat(line, num(games));
+    cat(line, " games)");
+    print(line);
+}
+
+/* Play games on update() alone under gravity, steering each tetrimino one
+ * move per update towards the placement the autoplayer picks from where it
+ * is, and locking it once it has landed there, or has been landed for
+ * GRAVITY_LANDED updates. That times the engine at speeds no timer could
+ * drive it at. */
+#define GRAVITY_UPDATES (200000)
+#define GRAVITY_LANDED  (8)
+
+static void bench_gravity(uint16_t gravity)
+{
+    struct tetris *game = &bench_game;
+    struct board board;
+    struct placement target;
+    uint64_t t, updates, pieces = 0, lines = 0, games = 0;
+    uint32_t game_seed = 1, locks = -1, landed_for = 0;
+    bool found = false;
+    char line[160] = "gravity ";
+    uint8_t i;
+
+    reset(game, game_seed, gravity);
+    t = ticks();
+    for (updates = 0; updates < GRAVITY_UPDATES; updates++) {
+        if (game->locks != locks) {
+            locks = game->locks;
+            landed_for = 0;
+            board_load(&board, game);
+            found = ai_search(&board, game->current.i, game->current.y,
+                              &default_weights, &target);
+        }
+        if (found && game->current.r != target.r)
+            rotate(game);
+        else if (found && game->current.x != target.x)
+            move(game, game->current.x < target.x ? 1 : -1, 0);
+        update(game);
+        if (game->gravity && landed(game) &&
+            (++landed_for > GRAVITY_LANDED || !found ||
+             (game->current.r == target.r && game->current.x == target.x)))
+            lock_down(game);
+        if (game->locks != locks)
+            pieces++;
+        for (i = 0; i < 4; i++)
+            lines += game->cleared_rows[i] >= 0;
+        if (game->cleared_rows[0] >= 0)
+            clear_rows(game);
+        if (game->game_over) {
+            games++;
+            reset(game, ++game_seed, gravity);
+            locks = -1;
+        }
+    }
+    t = ticks() - t;
+
+    if (gravity) {
+        cat_hundredths(line, gravity * 100 / GRAVITY_UNIT);
+        cat(line, "G: ");
+    } else
+        cat(line, "classic: ");
+    cat(line, num(updates * 1000 * tpms / t));
+    cat(line, " updates/s, ");
+    cat(line, num(pieces * 1000 * tpms / t));
+    cat(line, " pieces/s (");
+    cat(line, num(pieces));
+    cat(line, " pieces, ");
+    cat(line, num(lines));
+    cat(line, " lines, ");
+    cat(line, num(games));
+    cat(line, " games)");
+    print(line);
+}
+
+/* Time the two-tetrimino lookahead search on every test well, on one
+ * processor and on all of them, and check that both find the same placement. */
+static void bench_lookahead(void)
+{
+    struct board boards[BENCH_WELLS];
+    struct placement one, all;
+    uint64_t t, single = 0, multi = 0;
+    uint32_t i, errors = 0;
+    bool found;
+    char line[128] = "";
+
+    for (i = 0; i < BENCH_WELLS; i++)
+        board_load(&boards[i], &wells[i]);
+    for (i = 0; i < BENCH_WELLS; i++) {
+        t = ticks();
+        found = ai_lookahead(&boards[i], i % 7, (i + 3) % 7, 0,
+                             &default_weights, false, NULL, &one);
+        single += ticks() - t;
+        t = ticks();
+        if (found != ai_lookahead(&boards[i], i % 7, (i + 3) % 7, 0,
+                                  &default_weights, true, NULL, &all) ||
+            (found && memcmp(&one, &all, sizeof(one))))
+            errors++;
+        multi += ticks() - t;
+    }
+
+    cat(line, "lookahead: 1 processor ");
+    cat_hundredths(line, single * 100000 / tpms / BENCH_WELLS);
+    cat(line, " us, ");
+    cat(line, num(processors()));
+    cat(line, " processors ");
+    cat_hundredths(line, multi * 100000 / tpms / BENCH_WELLS);
+    cat(line, " us, speedup ");
+    cat_hundredths(line, multi ? single * 100 / multi : 0);
+    cat(line, "x, mismatches ");
+    cat(line, num(errors));
+    print(line);
+}
+
+/* Score every placement of a tetrimino on the test wells, one board at a
+ * time with board_evaluate() and a batch at a time with each evaluator the
+ * processor has, and check that they all give the same scores. */
+#define BENCH_BATCHES (64)
+#define CANDIDATES    (BENCH_BATCHES * BATCH)
+
+static struct batch batches[BENCH_BATCHES];
+static struct board candidates[CANDIDATES];
+static int32_t scores[CANDIDATES], batch_scores[CANDIDATES];
+
+/* Append the rate of n candidates in t ticks, in millions per second. */
+static void cat_rate(char *line, uint64_t n, uint64_t t)
+{
+    cat_hundredths(line, t ? n * tpms / t / 10 : 0);
+}
+
+static void bench_evaluate(void)
+{
+    enum evaluator e, fastest = evaluator;
+    struct board b;
+    volatile int32_t sink;
+    uint64_t t;
+    uint32_t i, k, n = 0, round, errors = 0;
+    uint8_t r;
+    int8_t x, y;
+    char line[160] = "evaluate: board_evaluate ";
+
+    for (i = 0; n < CANDIDATES; i = (i + 1) % BENCH_WELLS) {
+        board_load(&b, &wells[i]);
+        for (r = 0; r < 4; r++)
+            for (x = -WALL; x < WELL_WIDTH && n < CANDIDATES; x++) {
+                if (board_collide(&b, i % 7, r, x, 0))
+                    continue;
+                for (y = 0; !board_collide(&b, i % 7, r, x, y + 1); y++)
+                    ;
+                candidates[n] = b;
+                batch_add(&batches[n / BATCH], &candidates[n],
+                          board_place(&candidates[n], i % 7, r, x, y));
+                n++;
+            }
+    }
+
+    t = ticks();
+    for (round = 0; round < BENCH_ROUNDS; round++)
+        for (k = 0; k < CANDIDATES; k++)
+            sink = board_evaluate(&candidates[k],
+                                  batches[k / BATCH].lines[k % BATCH],
+                                  &default_weights);
+    cat_rate(line, CANDIDATES * BENCH_ROUNDS, ticks() - t);
+    (void) sink;
+    for (k = 0; k < CANDIDATES; k++)
+        scores[k] = board_evaluate(&candidates[k],
+                                   batches[k / BATCH].lines[k % BATCH],
+                                   &default_weights);
+
+    for (e = 0; e < EVALUATOR__LENGTH; e++) {
+        cat(line, ", ");
+        cat(line, evaluator_names[e]);
+        cat(line, " ");
+        if (!evaluator_supported(e)) {
+            cat(line, "unsupported");
+            continue;
+        }
+        evaluator = e;
+        t = ticks();
+        for (round = 0; round < BENCH_ROUNDS; round++)
+            for (k = 0; k < BENCH_BATCHES; k++)
+                batch_evaluate(&batches[k], &default_weights,
+                               &batch_scores[k * BATCH]);
+        cat_rate(line, CANDIDATES * BENCH_ROUNDS, ticks() - t);
+        for (k = 0; k < CANDIDATES; k++)
+            errors += batch_scores[k] != scores[k];
+    }
+    evaluator = fastest;
+
+    cat(line, " M candidates/s, mismatches ");
+    cat(line, num(errors));
+    print(line);
+}
+
+/* Play a game with the lookahead, searching for every tetrimino with and
+ * without a transposition table, and check that both find the same
+ * placement and that the hash the engine keeps matches the well. */
+#define TABLE_PIECES (2000)
+
+static void bench_table(void)
+{
+    static struct table table;
+    struct tetris *game = &bench_game;
+    struct placement with, without;
+    struct board board;
+    uint64_t t, untabled = 0, tabled = 0;
+    uint32_t pieces, game_seed = 1, errors = 0, hash_errors = 0;
+    bool found;
+    char line[160] = "";
+
+    if (!table.entries && !table_init(&table)) {
+        print("table: not enough memory");
+        return;
+    }
+    reset(game, game_seed, 0);
+    for (pieces = 0; pieces < TABLE_PIECES; pieces++) {
+        board_load(&board, game);
+        if (board.hash != board_hash(&board))
+            hash_errors++;
+        t = ticks();
+        found = ai_lookahead(&board, game->current.i,
+                             game->bag[game->current.p], game->current.y,
+                             &default_weights, true, NULL, &without);
+        untabled += ticks() - t;
+        t = ticks();
+        if (found != ai_lookahead(&board, game->current.i,
+                                  game->bag[game->current.p],
+                                  game->current.y, &default_weights, true,
+                                  &table, &with) ||
+            (found && memcmp(&with, &without, sizeof(with))))
+            errors++;
+        tabled += ticks() - t;
+        if (found) {
+            game->current.r = without.r;
+            game->current.x = without.x;
+        }
+        drop(game);
+        if (game->cleared_rows[0] >= 0)
+            clear_rows(game);
+        if (game->game_over)
+            reset(game, ++game_seed, 0);
+    }
+
+    cat(line, "table: search ");
+    cat_hundredths(line, untabled * 100000 / tpms / TABLE_PIECES);
+    cat(line, " us, with table ");
+    cat_hundredths(line, tabled * 100000 / tpms / TABLE_PIECES);
+    cat(line, " us, ");
+    cat(line, num(untabled > tabled ?
+                  (untabled - tabled) * 100 / untabled : 0));
+    cat(line, "% less, hit rate ");
+    cat(line, num(table.lookups ? table.hits * 100 / table.lookups : 0));
+    cat(line, "%, mismatches ");
+    cat(line, num(errors));
+    cat(line, ", hash mismatches ");
+    cat(line, num(hash_errors));
+    print(line);
+}
+
+void bench(void)
+{
+    calibrate();
+    evaluator = evaluator_fastest();
+    reset(&bench_game, 1, 0);
+    bench_clear();
+    bench_evaluate();
+    bench_lookahead();
+    bench_table();
+    bench_sim("random", sim_random);
+    bench_sim("lowest", sim_lowest);
+    bench_sim("ai", sim_ai);
+    bench_gravity(0);
+    bench_gravity(GRAVITY_UNIT / 4);
+    bench_gravity(3 * GRAVITY_UNIT);
+    bench_gravity(GRAVITY_20G);
+}
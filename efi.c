@@ -0,0 +1,836 @@
+/*
+ *  UEFI Tetris
+ *  Copyright (C) 2013C2014, Curtis McEnroe programble@gmail.com
+ *
+ *  Permission to use, copy, modify, and/or distribute this software
+ *  for any purpose with or without fee is hereby granted, provided 
+ *  that the above copyright notice and this permission notice
+ *  appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ *  WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL
+ *  THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR 
+ *  CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ *  LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ *  NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ *  CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "platform.h"
+
+EFI_SIMPLE_TEXT_OUT_PROTOCOL *ConOut = NULL;
+EFI_SIMPLE_TEXT_IN_PROTOCOL *ConIn = NULL;
+EFI_SIMPLE_TEXT_INPUT_EX_PROTOCOL *ConInEx = NULL;
+
+/* Port I/O */
+
+static inline uint8_t inb(uint16_t p)
+{
+    uint8_t r;
+    asm("inb %1, %0" : "=a" (r) : "dN" (p));
+    return r;
+}
+
+static inline void outb(uint16_t p, uint8_t d)
+{
+    asm("outb %1, %0" : : "dN" (p), "a" (d));
+}
+
+/* Timing */
+
+/* Return the number of CPU ticks since boot. */
+static inline uint64_t rdtsc(void)
+{
+    uint32_t hi, lo;
+    asm volatile ("rdtsc" : "=a" (lo), "=d" (hi));
+    return ((uint64_t) lo) | (((uint64_t) hi) << 32);
+}
+
+static inline void cpuid(uint32_t leaf, uint32_t *a, uint32_t *b, uint32_t *c,
+                         uint32_t *d)
+{
+    asm volatile ("cpuid" : "=a" (*a), "=b" (*b), "=c" (*c), "=d" (*d)
+                          : "a" (leaf), "c" (0));
+}
+
+uint64_t ticks(void)
+{
+    return rdtsc();
+}
+
+uint64_t started;
+
+/* Return the current second field of the real-time-clock (RTC). Note that the
+ * value may or may not be represented in such a way that it should be
+ * formatted in hex to display the current second (i.e. 0x30 for the 30th
+ * second). */
+uint8_t rtcs(void)
+{
+    uint8_t last = 0, sec;
+    do { /* until value is the same twice in a row */
+        /* wait for update not in progress */
+        do { outb(0x70, 0x0A); } while (inb(0x71) & 0x80);
+        outb(0x70, 0x00);
+        sec = inb(0x71);
+    } while (sec != last && (last = sec));
+    return sec;
+}
+
+uint64_t tpms = 0;
+const char *calibration = "none";
+
+/* Return the TSC frequency in ticks per millisecond as reported by the CPU,
+ * or 0 if it does not say. Leaf 0x15 gives the TSC to crystal clock ratio and,
+ * on most parts, the crystal frequency; leaf 0x16 gives the base frequency,
+ * which the TSC runs at on parts that do not report the crystal. */
+static uint64_t tsc_cpuid(void)
+{
+    uint32_t a, b, c, d, max;
+    cpuid(0, &max, &b, &c, &d);
+    if (max >= 0x15) {
+        cpuid(0x15, &a, &b, &c, &d);
+        if (a && b && c)
+            return (uint64_t) c * b / a / 1000;
+    }
+    if (max >= 0x16) {
+        cpuid(0x16, &a, &b, &c, &d);
+        if (a & 0xFFFF)
+            return (uint64_t) (a & 0xFFFF) * 1000;
+    }
+    return 0;
+}
+
+/* Ticks per millisecond measured on an earlier boot, stored in a non-volatile
+ * variable together with the CPU signature (CPUID leaf 1 EAX) it was measured
+ * on. */
+struct calibration {
+    uint32_t signature;
+    uint64_t tpms;
+};
+
+EFI_GUID TetrisVariableGuid = { 0x5e7a1c3d, 0x8b2f, 0x4d6e,
+    { 0x9a, 0x41, 0x2c, 0x7e, 0x13, 0xb5, 0x60, 0xf8 } };
+#define CALIBRATION_VARIABLE L"TetrisCalibration"
+#define CALIBRATION_STALL (10) /* milliseconds */
+
+static uint32_t signature(void)
+{
+    uint32_t a, b, c, d;
+    cpuid(1, &a, &b, &c, &d);
+    return a;
+}
+
+/* Set tpms, taking the quickest source that is available: the frequency the
+ * CPU reports, the value cached by an earlier boot on the same CPU, or
+ * counting ticks across a short BS->Stall, whose result is then cached. */
+void calibrate(void)
+{
+    struct calibration cached;
+    uintn_t size = sizeof(cached);
+    EFI_STATUS status;
+    uint64_t t;
+
+    if (tpms)
+        return;
+
+    if ((tpms = tsc_cpuid())) {
+        calibration = "cpuid";
+        return;
+    }
+
+    status = uefi_call_wrapper (RT->GetVariable, 5, CALIBRATION_VARIABLE,
+                                &TetrisVariableGuid, NULL, &size, &cached);
+    if (!EFI_ERROR(status) && size == sizeof(cached) &&
+        cached.signature == signature() && cached.tpms) {
+        tpms = cached.tpms;
+        calibration = "cached";
+        return;
+    }
+
+    t = rdtsc();
+    uefi_call_wrapper (BS->Stall, 1, CALIBRATION_STALL * 1000);
+    tpms = (rdtsc() - t) / CALIBRATION_STALL;
+    calibration = "stall";
+
+    cached.signature = signature();
+    cached.tpms = tpms;
+    uefi_call_wrapper (RT->SetVariable, 5, CALIBRATION_VARIABLE,
+                       &TetrisVariableGuid,
+                       EFI_VARIABLE_NON_VOLATILE |
+                       EFI_VARIABLE_BOOTSERVICE_ACCESS |
+                       EFI_VARIABLE_RUNTIME_ACCESS,
+                       sizeof(cached), &cached);
+}
+
+void stall(uintn_t us)
+{
+    uefi_call_wrapper (BS->Stall, 1, us);
+}
+
+/* Keyboard Input */
+
+/* Keys are read through the extended text input protocol of the console
+ * input handle when it has one, and through ConIn otherwise. The extended
+ * protocol also reports presses of shift and toggle keys alone, as key data
+ * with no key in it; those are skipped. */
+int scan(void)
+{
+    EFI_STATUS status;
+    EFI_INPUT_KEY key;
+    EFI_KEY_DATA data;
+
+    if (ConInEx) {
+        do {
+            status = uefi_call_wrapper (ConInEx->ReadKeyStrokeEx, 2,
+                                        ConInEx, &data);
+            if (status != EFI_SUCCESS)
+                return 0;
+            key = data.Key;
+        } while (!key.ScanCode && !key.UnicodeChar);
+    } else {
+        status = uefi_call_wrapper (ConIn->ReadKeyStroke, 2, ConIn, &key);
+        if (status != EFI_SUCCESS)
+            return 0;
+    }
+    if (key.ScanCode != 0)
+        return key.ScanCode;
+    return (int) key.UnicodeChar;
+}
+
+const char *input_name(void)
+{
+    return ConInEx ? "text ex" : "text";
+}
+
+/* Timer event that wakes idle() up */
+EFI_EVENT idle_timer = NULL;
+
+/* Arm idle_timer to fire in ms milliseconds and wait for either it or a key
+ * through WaitForEvent, which lets the CPU halt until an interrupt instead of
+ * spinning. */
+void idle(uint32_t ms)
+{
+    EFI_EVENT events[2];
+    EFI_STATUS status;
+    uintn_t index;
+
+    if (!ms)
+        return;
+    if (!idle_timer) {
+        status = uefi_call_wrapper (BS->CreateEvent, 5, EVT_TIMER, 0, NULL,
+                                    NULL, &idle_timer);
+        if (EFI_ERROR(status)) {
+            idle_timer = NULL;
+            return;
+        }
+    }
+    /* Timer periods are in units of 100 ns */
+    uefi_call_wrapper (BS->SetTimer, 3, idle_timer, TimerRelative,
+                       (uint64_t) ms * 10000);
+    events[0] = ConInEx ? ConInEx->WaitForKeyEx : ConIn->WaitForKey;
+    events[1] = idle_timer;
+    uefi_call_wrapper (BS->WaitForEvent, 3, 2, events, &index);
+    uefi_call_wrapper (BS->SetTimer, 3, idle_timer, TimerCancel, 0);
+}
+
+/* Memory */
+
+void *allocate(uintn_t size)
+{
+    void *p;
+    if (EFI_ERROR(uefi_call_wrapper (BS->AllocatePool, 3, EfiLoaderData,
+                                     size, &p)))
+        return NULL;
+    return p;
+}
+
+/* Processors */
+
+/* EFI_MP_SERVICES_PROTOCOL, from the UEFI Platform Initialization
+ * specification rather than UEFI itself, so gnu-efi does not define it. Only
+ * the members used here are typed. */
+#define MP_SERVICES_PROTOCOL_GUID \
+    { 0x3fdda605, 0xa76e, 0x4f46, \
+      { 0xad, 0x29, 0x12, 0xf4, 0x53, 0x1b, 0x3d, 0x08 } }
+
+/* The firmware calls procedures on the APs with its own calling convention */
+#ifdef __x86_64__
+#define AP_PROCEDURE __attribute__((ms_abi))
+#else
+#define AP_PROCEDURE
+#endif
+
+struct mp_services {
+    EFI_STATUS (EFIAPI *GetNumberOfProcessors)(struct mp_services *this,
+                                               uintn_t *count,
+                                               uintn_t *enabled);
+    void *GetProcessorInfo;
+    EFI_STATUS (EFIAPI *StartupAllAPs)(struct mp_services *this,
+                                       void (AP_PROCEDURE *procedure)(void *),
+                                       BOOLEAN single_thread,
+                                       EFI_EVENT wait_event, uintn_t timeout,
+                                       void *argument, uintn_t **failed);
+    void *StartupThisAP;
+    void *SwitchBSP;
+    void *EnableDisableAP;
+    void *WhoAmI;
+};
+
+EFI_GUID MpServicesProtocol = MP_SERVICES_PROTOCOL_GUID;
+struct mp_services *MP = NULL;
+/* Enabled processors, 0 until looked up */
+uint32_t mp_processors = 0;
+/* Signalled when every AP has finished */
+EFI_EVENT mp_done = NULL;
+/* What the APs are running */
+void (*ap_work)(void *arg);
+
+static void AP_PROCEDURE ap_procedure(void *arg)
+{
+    ap_work(arg);
+}
+
+/* Without MP services, or with a single enabled processor, everything runs
+ * on the BSP. Under QEMU, -smp N gives N processors. */
+uint32_t processors(void)
+{
+    uintn_t count, enabled;
+
+    if (mp_processors)
+        return mp_processors;
+    mp_processors = 1;
+    if (EFI_ERROR(LibLocateProtocol(&MpServicesProtocol, (void **) &MP)))
+        return mp_processors;
+    if (EFI_ERROR(uefi_call_wrapper (MP->GetNumberOfProcessors, 3, MP,
+                                     &count, &enabled)) || enabled < 2)
+        return mp_processors;
+    if (EFI_ERROR(uefi_call_wrapper (BS->CreateEvent, 5, 0, 0, NULL, NULL,
+                                     &mp_done)))
+        return mp_processors;
+    mp_processors = enabled;
+    return mp_processors;
+}
+
+/* StartupAllAPs with an event returns at once, so the BSP does its share of
+ * the work instead of waiting, then waits for the event. */
+void parallel(void (*work)(void *arg), void *arg)
+{
+    EFI_STATUS status;
+    uintn_t index;
+
+    if (processors() < 2) {
+        work(arg);
+        return;
+    }
+    ap_work = work;
+    status = uefi_call_wrapper (MP->StartupAllAPs, 7, MP, ap_procedure,
+                                FALSE, mp_done, 0, arg, NULL);
+    work(arg);
+    if (!EFI_ERROR(status))
+        uefi_call_wrapper (BS->WaitForEvent, 3, 1, &mp_done, &index);
+}
+
+/* PC Speaker */
+
+void speaker_on(uint32_t hz)
+{
+    uint32_t div = 0;
+    if (hz < 20)
+        hz = 20;
+    if (hz > 20000)
+        hz = 20000;
+    div = 1193180 / hz;
+    /* speaker freq */
+    outb(0x43, 0xB6);
+    outb(0x42, (uint8_t) div);
+    outb(0x42, (uint8_t) (div >> 8));
+    /* speaker on */
+    outb(0x61, inb(0x61) | 0x3);
+}
+
+void speaker_off(void)
+{
+    outb(0x61, inb(0x61) & 0xFC);
+}
+
+/* Console */
+
+/* Console backends that present() outputs changed cells through */
+struct backend {
+    const char *name;
+    /* Output the changed cells of row y from x0 up to but not including x1.
+     * Cells in that range that did not change may be output too. */
+    void (*row)(uint8_t y, uint8_t x0, uint8_t x1);
+    /* Finish outputting a frame */
+    void (*end)(void);
+};
+
+/* Text backend: each run of cells with the same attribute, from the first to
+ * the last changed cell in it, goes out as a single OutputString. The cursor
+ * position and attribute are only set when they differ from where the
+ * previous run left them. */
+
+uintn_t text_x = COLS, text_y = ROWS, text_attr = 0xFF;
+
+static void text_row(uint8_t y, uint8_t x0, uint8_t x1)
+{
+    char16_t str[COLS + 1];
+    uint8_t x, start, len, attr;
+
+    for (x = x0; x < x1;) {
+        if (!changed(x, y)) {
+            x++;
+            continue;
+        }
+        attr = screen[y][x].attr;
+        for (start = x, len = 0; x < x1 && screen[y][x].attr == attr; x++)
+            if (changed(x, y))
+                len = x - start + 1;
+        for (x = start; x < start + len; x++)
+            str[x - start] = screen[y][x].c;
+        str[len] = 0;
+
+        if (text_x != start || text_y != y) {
+            PROFILE_BEGIN(SECTION_FIRMWARE);
+            uefi_call_wrapper (ConOut->SetCursorPosition, 3, ConOut, start, y);
+            PROFILE_END(SECTION_FIRMWARE);
+            fw_calls++;
+        }
+        if (text_attr != attr) {
+            PROFILE_BEGIN(SECTION_FIRMWARE);
+            uefi_call_wrapper (ConOut->SetAttribute, 2, ConOut, attr);
+            PROFILE_END(SECTION_FIRMWARE);
+            text_attr = attr;
+            fw_calls++;
+        }
+        PROFILE_BEGIN(SECTION_FIRMWARE);
+        uefi_call_wrapper (ConOut->OutputString, 2, ConOut, str);
+        PROFILE_END(SECTION_FIRMWARE);
+        fw_calls++;
+        /* Where the cursor goes after the last column is up to the console.
+         */
+        text_x = x < COLS ? x : COLS;
+        text_y = y;
+    }
+}
+
+static void text_end(void)
+{
+}
+
+struct backend text_backend = { "text", text_row, text_end };
+
+/* Graphics backend: cells are drawn with a built-in 8x8 font, doubled
+ * vertically, into an off-screen frame of the whole 80x25 screen centered on
+ * the display. Changed spans of consecutive rows are merged into one rectangle
+ * which is copied to video memory with a single Blt. */
+
+#define CELL_WIDTH   (8)
+#define CELL_HEIGHT  (16)
+#define FRAME_WIDTH  (COLS * CELL_WIDTH)
+#define FRAME_HEIGHT (ROWS * CELL_HEIGHT)
+
+EFI_GRAPHICS_OUTPUT_PROTOCOL *GOP = NULL;
+EFI_GRAPHICS_OUTPUT_BLT_PIXEL *frame = NULL;
+/* Position of the frame on the display */
+uintn_t frame_x, frame_y;
+
+/* Pending rectangle of cells to copy, x1 and y1 exclusive. Empty if y0 ==
+ * y1. */
+uint8_t blt_x0, blt_y0, blt_x1, blt_y1;
+
+/* Text attribute colors, from TERM_BLACK to TERM_WHITE */
+const EFI_GRAPHICS_OUTPUT_BLT_PIXEL palette[16] = {
+    {0x00, 0x00, 0x00, 0}, {0xAA, 0x00, 0x00, 0},
+    {0x00, 0xAA, 0x00, 0}, {0xAA, 0xAA, 0x00, 0},
+    {0x00, 0x00, 0xAA, 0}, {0xAA, 0x00, 0xAA, 0},
+    {0x00, 0x55, 0xAA, 0}, {0xAA, 0xAA, 0xAA, 0},
+    {0x55, 0x55, 0x55, 0}, {0xFF, 0x55, 0x55, 0},
+    {0x55, 0xFF, 0x55, 0}, {0xFF, 0xFF, 0x55, 0},
+    {0x55, 0x55, 0xFF, 0}, {0xFF, 0x55, 0xFF, 0},
+    {0x55, 0xFF, 0xFF, 0}, {0xFF, 0xFF, 0xFF, 0}
+};
+
+/* Glyphs for ' ' to '~', one byte per pixel row, least significant bit
+ * leftmost. */
+const uint8_t font[95][8] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, /*   */
+    {0x18, 0x3C, 0x3C, 0x18, 0x18, 0x00, 0x18, 0x00}, /* ! */
+    {0x36, 0x36, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, /* " */
+    {0x36, 0x36, 0x7F, 0x36, 0x7F, 0x36, 0x36, 0x00}, /* # */
+    {0x0C, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x0C, 0x00}, /* $ */
+    {0x00, 0x63, 0x33, 0x18, 0x0C, 0x66, 0x63, 0x00}, /* % */
+    {0x1C, 0x36, 0x1C, 0x6E, 0x3B, 0x33, 0x6E, 0x00}, /* & */
+    {0x06, 0x06, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00}, /* ' */
+    {0x18, 0x0C, 0x06, 0x06, 0x06, 0x0C, 0x18, 0x00}, /* ( */
+    {0x06, 0x0C, 0x18, 0x18, 0x18, 0x0C, 0x06, 0x00}, /* ) */
+    {0x00, 0x66, 0x3C, 0xFF, 0x3C, 0x66, 0x00, 0x00}, /* * */
+    {0x00, 0x0C, 0x0C, 0x3F, 0x0C, 0x0C, 0x00, 0x00}, /* + */
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x06}, /* , */
+    {0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x00}, /* - */
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00}, /* . */
+    {0x60, 0x30, 0x18, 0x0C, 0x06, 0x03, 0x01, 0x00}, /* / */
+    {0x3E, 0x63, 0x73, 0x7B, 0x6F, 0x67, 0x3E, 0x00}, /* 0 */
+    {0x0C, 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x3F, 0x00}, /* 1 */
+    {0x1E, 0x33, 0x30, 0x1C, 0x06, 0x33, 0x3F, 0x00}, /* 2 */
+    {0x1E, 0x33, 0x30, 0x1C, 0x30, 0x33, 0x1E, 0x00}, /* 3 */
+    {0x38, 0x3C, 0x36, 0x33, 0x7F, 0x30, 0x78, 0x00}, /* 4 */
+    {0x3F, 0x03, 0x1F, 0x30, 0x30, 0x33, 0x1E, 0x00}, /* 5 */
+    {0x1C, 0x06, 0x03, 0x1F, 0x33, 0x33, 0x1E, 0x00}, /* 6 */
+    {0x3F, 0x33, 0x30, 0x18, 0x0C, 0x0C, 0x0C, 0x00}, /* 7 */
+    {0x1E, 0x33, 0x33, 0x1E, 0x33, 0x33, 0x1E, 0x00}, /* 8 */
+    {0x1E, 0x33, 0x33, 0x3E, 0x30, 0x18, 0x0E, 0x00}, /* 9 */
+    {0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x00}, /* : */
+    {0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x06}, /* ; */
+    {0x18, 0x0C, 0x06, 0x03, 0x06, 0x0C, 0x18, 0x00}, /* < */
+    {0x00, 0x00, 0x3F, 0x00, 0x00, 0x3F, 0x00, 0x00}, /* = */
+    {0x06, 0x0C, 0x18, 0x30, 0x18, 0x0C, 0x06, 0x00}, /* > */
+    {0x1E, 0x33, 0x30, 0x18, 0x0C, 0x00, 0x0C, 0x00}, /* ? */
+    {0x3E, 0x63, 0x7B, 0x7B, 0x7B, 0x03, 0x1E, 0x00}, /* @ */
+    {0x0C, 0x1E, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x00}, /* A */
+    {0x3F, 0x66, 0x66, 0x3E, 0x66, 0x66, 0x3F, 0x00}, /* B */
+    {0x3C, 0x66, 0x03, 0x03, 0x03, 0x66, 0x3C, 0x00}, /* C */
+    {0x1F, 0x36, 0x66, 0x66, 0x66, 0x36, 0x1F, 0x00}, /* D */
+    {0x7F, 0x46, 0x16, 0x1E, 0x16, 0x46, 0x7F, 0x00}, /* E */
+    {0x7F, 0x46, 0x16, 0x1E, 0x16, 0x06, 0x0F, 0x00}, /* F */
+    {0x3C, 0x66, 0x03, 0x03, 0x73, 0x66, 0x7C, 0x00}, /* G */
+    {0x33, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x33, 0x00}, /* H */
+    {0x1E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00}, /* I */
+    {0x78, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E, 0x00}, /* J */
+    {0x67, 0x66, 0x36, 0x1E, 0x36, 0x66, 0x67, 0x00}, /* K */
+    {0x0F, 0x06, 0x06, 0x06, 0x46, 0x66, 0x7F, 0x00}, /* L */
+    {0x63, 0x77, 0x7F, 0x7F, 0x6B, 0x63, 0x63, 0x00}, /* M */
+    {0x63, 0x67, 0x6F, 0x7B, 0x73, 0x63, 0x63, 0x00}, /* N */
+    {0x1C, 0x36, 0x63, 0x63, 0x63, 0x36, 0x1C, 0x00}, /* O */
+    {0x3F, 0x66, 0x66, 0x3E, 0x06, 0x06, 0x0F, 0x00}, /* P */
+    {0x1E, 0x33, 0x33, 0x33, 0x3B, 0x1E, 0x38, 0x00}, /* Q */
+    {0x3F, 0x66, 0x66, 0x3E, 0x36, 0x66, 0x67, 0x00}, /* R */
+    {0x1E, 0x33, 0x07, 0x0E, 0x38, 0x33, 0x1E, 0x00}, /* S */
+    {0x3F, 0x2D, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00}, /* T */
+    {0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x3F, 0x00}, /* U */
+    {0x33, 0x33, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00}, /* V */
+    {0x63, 0x63, 0x63, 0x6B, 0x7F, 0x77, 0x63, 0x00}, /* W */
+    {0x63, 0x63, 0x36, 0x1C, 0x1C, 0x36, 0x63, 0x00}, /* X */
+    {0x33, 0x33, 0x33, 0x1E, 0x0C, 0x0C, 0x1E, 0x00}, /* Y */
+    {0x7F, 0x63, 0x31, 0x18, 0x4C, 0x66, 0x7F, 0x00}, /* Z */
+    {0x1E, 0x06, 0x06, 0x06, 0x06, 0x06, 0x1E, 0x00}, /* [ */
+    {0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0x40, 0x00}, /* \ */
+    {0x1E, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1E, 0x00}, /* ] */
+    {0x08, 0x1C, 0x36, 0x63, 0x00, 0x00, 0x00, 0x00}, /* ^ */
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF}, /* _ */
+    {0x0C, 0x0C, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00}, /* ` */
+    {0x00, 0x00, 0x1E, 0x30, 0x3E, 0x33, 0x6E, 0x00}, /* a */
+    {0x07, 0x06, 0x06, 0x3E, 0x66, 0x66, 0x3B, 0x00}, /* b */
+    {0x00, 0x00, 0x1E, 0x33, 0x03, 0x33, 0x1E, 0x00}, /* c */
+    {0x38, 0x30, 0x30, 0x3E, 0x33, 0x33, 0x6E, 0x00}, /* d */
+    {0x00, 0x00, 0x1E, 0x33, 0x3F, 0x03, 0x1E, 0x00}, /* e */
+    {0x1C, 0x36, 0x06, 0x0F, 0x06, 0x06, 0x0F, 0x00}, /* f */
+    {0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x1F}, /* g */
+    {0x07, 0x06, 0x36, 0x6E, 0x66, 0x66, 0x67, 0x00}, /* h */
+    {0x0C, 0x00, 0x0E, 0x0C, 0x0C, 0x0C, 0x1E, 0x00}, /* i */
+    {0x30, 0x00, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E}, /* j */
+    {0x07, 0x06, 0x66, 0x36, 0x1E, 0x36, 0x67, 0x00}, /* k */
+    {0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00}, /* l */
+    {0x00, 0x00, 0x33, 0x7F, 0x7F, 0x6B, 0x63, 0x00}, /* m */
+    {0x00, 0x00, 0x1F, 0x33, 0x33, 0x33, 0x33, 0x00}, /* n */
+    {0x00, 0x00, 0x1E, 0x33, 0x33, 0x33, 0x1E, 0x00}, /* o */
+    {0x00, 0x00, 0x3B, 0x66, 0x66, 0x3E, 0x06, 0x0F}, /* p */
+    {0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x78}, /* q */
+    {0x00, 0x00, 0x3B, 0x6E, 0x66, 0x06, 0x0F, 0x00}, /* r */
+    {0x00, 0x00, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x00}, /* s */
+    {0x08, 0x0C, 0x3E, 0x0C, 0x0C, 0x2C, 0x18, 0x00}, /* t */
+    {0x00, 0x00, 0x33, 0x33, 0x33, 0x33, 0x6E, 0x00}, /* u */
+    {0x00, 0x00, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00}, /* v */
+    {0x00, 0x00, 0x63, 0x6B, 0x7F, 0x7F, 0x36, 0x00}, /* w */
+    {0x00, 0x00, 0x63, 0x36, 0x1C, 0x36, 0x63, 0x00}, /* x */
+    {0x00, 0x00, 0x33, 0x33, 0x33, 0x3E, 0x30, 0x1F}, /* y */
+    {0x00, 0x00, 0x3F, 0x19, 0x0C, 0x26, 0x3F, 0x00}, /* z */
+    {0x38, 0x0C, 0x0C, 0x07, 0x0C, 0x0C, 0x38, 0x00}, /* { */
+    {0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00}, /* | */
+    {0x07, 0x0C, 0x0C, 0x38, 0x0C, 0x0C, 0x07, 0x00}, /* } */
+    {0x6E, 0x3B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, /* ~ */
+};
+
+/* Draw the cell at x, y of screen into frame. */
+static void gop_cell(uint8_t x, uint8_t y)
+{
+    EFI_GRAPHICS_OUTPUT_BLT_PIXEL fg, bg, *p;
+    const uint8_t *glyph;
+    uint8_t c = screen[y][x].c, attr = screen[y][x].attr, i, j;
+
+    fg = palette[attr & 0x0F];
+    bg = palette[(attr >> 4) & 0x07];
+    glyph = font[c >= ' ' && c <= '~' ? c - ' ' : 0];
+    p = frame + y * CELL_HEIGHT * FRAME_WIDTH + x * CELL_WIDTH;
+    for (j = 0; j < CELL_HEIGHT; j++, p += FRAME_WIDTH)
+        for (i = 0; i < CELL_WIDTH; i++)
+            p[i] = glyph[j / 2] & (1 << i) ? fg : bg;
+}
+
+/* Copy the pending rectangle from frame to video memory. */
+static void gop_blt(void)
+{
+    if (blt_y0 == blt_y1)
+        return;
+    PROFILE_BEGIN(SECTION_FIRMWARE);
+    uefi_call_wrapper (GOP->Blt, 10, GOP, frame, EfiBltBufferToVideo,
+                       blt_x0 * CELL_WIDTH, blt_y0 * CELL_HEIGHT,
+                       frame_x + blt_x0 * CELL_WIDTH,
+                       frame_y + blt_y0 * CELL_HEIGHT,
+                       (blt_x1 - blt_x0) * CELL_WIDTH,
+                       (blt_y1 - blt_y0) * CELL_HEIGHT,
+                       FRAME_WIDTH * sizeof(EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+    PROFILE_END(SECTION_FIRMWARE);
+    fw_calls++;
+    blt_y0 = blt_y1 = 0;
+}
+
+static void gop_row(uint8_t y, uint8_t x0, uint8_t x1)
+{
+    uint8_t x;
+    for (x = x0; x < x1; x++)
+        if (changed(x, y))
+            gop_cell(x, y);
+
+    if (blt_y0 != blt_y1 && blt_y1 == y) {
+        if (x0 < blt_x0)
+            blt_x0 = x0;
+        if (x1 > blt_x1)
+            blt_x1 = x1;
+        blt_y1 = y + 1;
+        return;
+    }
+    gop_blt();
+    blt_x0 = x0;
+    blt_x1 = x1;
+    blt_y0 = y;
+    blt_y1 = y + 1;
+}
+
+static void gop_end(void)
+{
+    gop_blt();
+}
+
+struct backend gop_backend = { "GOP", gop_row, gop_end };
+
+struct backend *backend = &text_backend;
+
+/* Use the graphics backend if the firmware has a Graphics Output Protocol
+ * with a mode large enough for the whole frame. Clear the display to black. */
+static void gop_init(void)
+{
+    EFI_GRAPHICS_OUTPUT_BLT_PIXEL black = {0, 0, 0, 0};
+    EFI_STATUS status;
+    uintn_t w, h;
+
+    status = LibLocateProtocol(&GraphicsOutputProtocol, (void **) &GOP);
+    if (EFI_ERROR(status) || !GOP)
+        return;
+    w = GOP->Mode->Info->HorizontalResolution;
+    h = GOP->Mode->Info->VerticalResolution;
+    if (w < FRAME_WIDTH || h < FRAME_HEIGHT)
+        return;
+    status = uefi_call_wrapper (BS->AllocatePool, 3, EfiLoaderData,
+        FRAME_WIDTH * FRAME_HEIGHT * sizeof(EFI_GRAPHICS_OUTPUT_BLT_PIXEL),
+        (void **) &frame);
+    if (EFI_ERROR(status))
+        return;
+    frame_x = (w - FRAME_WIDTH) / 2;
+    frame_y = (h - FRAME_HEIGHT) / 2;
+    uefi_call_wrapper (GOP->Blt, 10, GOP, &black, EfiBltVideoFill,
+                       0, 0, 0, 0, w, h, 0);
+    backend = &gop_backend;
+}
+
+static void gop_fini(void)
+{
+    if (frame)
+        uefi_call_wrapper (BS->FreePool, 1, frame);
+    frame = NULL;
+    backend = &text_backend;
+}
+
+/* Console cursor position and attributes from before the game started */
+SIMPLE_TEXT_OUTPUT_MODE mode;
+
+void console_init(void)
+{
+    memcpy(&mode, ConOut->Mode, sizeof(SIMPLE_TEXT_OUTPUT_MODE));
+    uefi_call_wrapper (ConOut->EnableCursor, 2, ConOut, 0);
+    gop_init();
+}
+
+void console_fini(void)
+{
+    if (idle_timer)
+        uefi_call_wrapper (BS->CloseEvent, 1, idle_timer);
+    idle_timer = NULL;
+    gop_fini();
+    uefi_call_wrapper (ConOut->EnableCursor, 2, ConOut, mode.CursorVisible);
+    uefi_call_wrapper (ConOut->SetCursorPosition, 3,
+                       ConOut, mode.CursorColumn, mode.CursorRow);
+    uefi_call_wrapper (ConOut->SetAttribute, 2, ConOut, mode.Attribute);
+}
+
+void console_row(uint8_t y, uint8_t x0, uint8_t x1)
+{
+    backend->row(y, x0, x1);
+}
+
+void console_end(void)
+{
+    backend->end();
+}
+
+const char *console_name(void)
+{
+    return backend->name;
+}
+
+void print(const char *s)
+{
+    char16_t str[COLS + 1];
+    uintn_t i;
+    do {
+        for (i = 0; *s && i < COLS; i++)
+            str[i] = *s++;
+        str[i] = 0;
+        uefi_call_wrapper (ConOut->OutputString, 2, ConOut, str);
+    } while (*s);
+    uefi_call_wrapper (ConOut->OutputString, 2, ConOut, (char16_t *) L"\r\n");
+}
+
+/* Load Options */
+
+EFI_LOADED_IMAGE *Image = NULL;
+
+/* Look for name among the space-separated words of the load options the image
+ * was started with (for example "tetris.efi bench" in the UEFI shell). A name
+ * ending in '=' matches the beginning of a word, otherwise the whole word has
+ * to match. Return the rest of the matching word, or NULL if there is none. */
+static const char16_t *option(const char *name)
+{
+    const char16_t *p, *end;
+    const char *q;
+
+    if (!Image || !Image->LoadOptions)
+        return NULL;
+    p = Image->LoadOptions;
+    end = p + Image->LoadOptionsSize / sizeof(char16_t);
+    while (p < end && *p) {
+        if (*p == ' ') {
+            p++;
+            continue;
+        }
+        for (q = name; p < end && *q && *p == (char16_t) *q; p++, q++)
+            ;
+        if (!*q && (q[-1] == '=' || p == end || !*p || *p == ' '))
+            return p;
+        while (p < end && *p && *p != ' ')
+            p++;
+    }
+    return NULL;
+}
+
+/* Return the decimal number at the start of s, or def if there is none. */
+static uint32_t number(const char16_t *s, uint32_t def)
+{
+    uint32_t n = 0;
+    if (!s || *s < '0' || *s > '9')
+        return def;
+    while (*s >= '0' && *s <= '9')
+        n = n * 10 + (*s++ - '0');
+    return n;
+}
+
+/* Files */
+
+/* Open name in the root directory of the volume this image was loaded from,
+ * usually the EFI system partition. */
+static EFI_FILE_HANDLE file_open(const char *name, uint64_t mode)
+{
+    EFI_FILE_IO_INTERFACE *volume;
+    EFI_FILE_HANDLE root, file;
+    EFI_STATUS status;
+    char16_t path[64];
+    uint8_t i;
+
+    if (!Image)
+        return NULL;
+    status = uefi_call_wrapper (BS->HandleProtocol, 3, Image->DeviceHandle,
+                                &FileSystemProtocol, (void **) &volume);
+    if (EFI_ERROR(status))
+        return NULL;
+    status = uefi_call_wrapper (volume->OpenVolume, 2, volume, &root);
+    if (EFI_ERROR(status))
+        return NULL;
+    path[0] = '\\';
+    for (i = 0; name[i] && i < 62; i++)
+        path[i + 1] = name[i];
+    path[i + 1] = 0;
+    status = uefi_call_wrapper (root->Open, 5, root, &file, path, mode, 0);
+    uefi_call_wrapper (root->Close, 1, root);
+    return EFI_ERROR(status) ? NULL : file;
+}
+
+bool file_save(const char *name, const void *data, uintn_t size)
+{
+    EFI_FILE_HANDLE file;
+    EFI_STATUS status;
+    uintn_t written = size;
+
+    /* Opening an existing file does not truncate it, so delete it first. */
+    if ((file = file_open(name, EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE)))
+        uefi_call_wrapper (file->Delete, 1, file);
+    file = file_open(name, EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE |
+                           EFI_FILE_MODE_CREATE);
+    if (!file)
+        return false;
+    status = uefi_call_wrapper (file->Write, 3, file, &written, (void *) data);
+    uefi_call_wrapper (file->Close, 1, file);
+    return !EFI_ERROR(status) && written == size;
+}
+
+bool file_load(const char *name, void *data, uintn_t *size)
+{
+    EFI_FILE_HANDLE file;
+    EFI_STATUS status;
+
+    if (!(file = file_open(name, EFI_FILE_MODE_READ)))
+        return false;
+    status = uefi_call_wrapper (file->Read, 3, file, size, data);
+    uefi_call_wrapper (file->Close, 1, file);
+    return !EFI_ERROR(status);
+}
+
+EFI_STATUS
+EFIAPI
+efi_main (EFI_HANDLE ImageHandle, EFI_SYSTEM_TABLE *SystemTable)
+{
+    started = rdtsc();
+    InitializeLib(ImageHandle, SystemTable);
+    ConOut = SystemTable->ConOut;
+    ConIn = SystemTable->ConIn;
+    if (EFI_ERROR(uefi_call_wrapper (BS->HandleProtocol, 3,
+                                     SystemTable->ConsoleInHandle,
+                                     &SimpleTextInputExProtocol,
+                                     (void **) &ConInEx)))
+        ConInEx = NULL;
+    uefi_call_wrapper (BS->HandleProtocol, 3, ImageHandle,
+                       &LoadedImageProtocol, (void **) &Image);
+    das = number(option("das="), das);
+    arr = number(option("arr="), arr);
+    seed = number(option("seed="), seed);
+    gravity = number(option("gravity="), gravity);
+    if (option("replay"))
+        playback = PLAYBACK_REAL_TIME;
+    if (option("replay=fast"))
+        playback = PLAYBACK_FAST;
+    if (option("bench"))
+        bench();
+    else
+        game();
+    return EFI_SUCCESS;
+}
@@ -0,0 +1,1439 @@
+/*
+ *  UEFI Tetris
+ *  Copyright (C) 2013C2014, Curtis McEnroe programble@gmail.com
+ *
+ *  Permission to use, copy, modify, and/or distribute this software
+ *  for any purpose with or without fee is hereby granted, provided 
+ *  that the above copyright notice and this permission notice
+ *  appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ *  WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL
+ *  THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR 
+ *  CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ *  LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ *  NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ *  CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "tetris.h"
+#include "replay.h"
+#include "ai.h"
+
+/* Delay in milliseconds before rows are cleared */
+#define CLEAR_DELAY (100)
+/* Under any gravity but the classic one, the time in milliseconds a tetrimino
+ * that has landed waits before it locks, and the number of times moving or
+ * rotating it can start the wait over */
+#define LOCK_DELAY (500)
+#define LOCK_RESETS (15)
+/* Longest time in milliseconds the main loop sleeps waiting for a key, and
+ * the time it sleeps at most while the debug overlay is shown */
+#define IDLE_TIMEOUT (1000)
+#define DEBUG_REFRESH (100)
+
+/* The game being played */
+struct tetris tetris;
+uint32_t seed = 0, gravity = 0;
+
+/* The autoplayer's transposition table, if it could be allocated */
+struct table table;
+bool table_ready = false;
+
+bool paused = false;
+
+/* Pages of the debug overlay, cycled through with the D key */
+enum page {
+    PAGE_OFF,
+    PAGE_STATE,
+    PAGE_LATENCY,
+#ifdef PROFILE
+    PAGE_PROFILE,
+#endif
+    PAGE__LENGTH
+};
+
+enum page debug = PAGE_OFF;
+bool help = true, statistics = false;
+int last_key = 0;
+
+enum playback playback = PLAYBACK_OFF;
+
+/* When the game started, which replay event times are counted from */
+uint64_t game_start = 0;
+
+/* Latency histograms, in microseconds. Buckets below 4 us are 1 us wide;
+ * above that each power of two is split into 4 buckets, so a percentile is
+ * within 25% of the real value. */
+#define HISTOGRAM_BUCKETS (4 * 31)
+
+struct histogram {
+    const char *name;
+    uint32_t samples, max;
+    uint32_t buckets[HISTOGRAM_BUCKETS];
+};
+
+/* From a key being read to the end of the present() that shows its effect,
+ * and the time taken by update() */
+struct histogram key_latency = { "key to screen" };
+struct histogram update_time = { "update" };
+
+/* From each gravity step's deadline to when it ran */
+struct histogram gravity_late = { "gravity late" };
+
+/* Times the keys read in this frame were read at */
+#define KEYS_PER_FRAME (16)
+uint64_t key_ticks[KEYS_PER_FRAME];
+uint8_t keys_read = 0;
+
+static uint32_t bucket(uint32_t us)
+{
+    uint8_t log;
+    if (us < 4)
+        return us;
+    log = 31 - __builtin_clz(us);
+    return 4 * (log - 1) + ((us >> (log - 2)) & 3);
+}
+
+/* Return the largest number of microseconds that goes in bucket b */
+static uint32_t bucket_max(uint32_t b)
+{
+    uint8_t log = b / 4 + 1;
+    if (b < 4)
+        return b;
+    return ((uint32_t) (5 + b % 4) << (log - 2)) - 1;
+}
+
+static void histogram_add(struct histogram *h, uint64_t t)
+{
+    uint64_t us = t * 1000 / tpms;
+    if (us > 0xFFFFFFFF)
+        us = 0xFFFFFFFF;
+    h->samples++;
+    h->buckets[bucket(us)]++;
+    if (us > h->max)
+        h->max = us;
+}
+
+/* Return the p-th percentile of h in microseconds, rounded up to the top of
+ * its bucket. */
+static uint32_t percentile(const struct histogram *h, uint32_t p)
+{
+    uint32_t b, n = 0, rank = ((uint64_t) h->samples * p + 99) / 100;
+    if (!h->samples)
+        return 0;
+    for (b = 0; b < HISTOGRAM_BUCKETS - 1; b++)
+        if ((n += h->buckets[b]) >= rank)
+            break;
+    return bucket_max(b) < h->max ? bucket_max(b) : h->max;
+}
+
+/* Timing */
+
+/* IDs used to keep separate timing operations separate */
+enum timer {
+    TIMER_UPDATE,
+    TIMER_CLEAR,
+    TIMER_AI,
+    TIMER_LOCK,
+    TIMER__LENGTH
+};
+
+/* For interval(), the deadline of the last step, or 0 if the timer is not
+ * running; for wait(), when it started, or 0 if it is not waiting. */
+uint64_t timers[TIMER__LENGTH] = {0};
+
+/* Most steps interval() returns at once to catch up with its deadlines */
+#define MAX_CATCH_UP (4)
+
+/* Steps of each interval timer that were run to catch up, and that were
+ * dropped because there were more than MAX_CATCH_UP of them */
+uint32_t late_steps[TIMER__LENGTH], dropped_steps[TIMER__LENGTH];
+
+/* Return the number of steps of ms milliseconds of this timer that are due,
+ * and count them as done. A timer that is not running starts with a step.
+ * Deadlines are kept on a fixed grid, each one ms after the last rather than
+ * after the time it was found to be due, so time the main loop loses is made
+ * up by running the steps that fell due meanwhile, and the steps keep their
+ * rate however late the loop is. If lateness is not NULL, the time from each
+ * step's deadline until now is added to it. */
+static uint32_t interval(enum timer timer, uint32_t ms,
+                         struct histogram *lateness)
+{
+    uint64_t tf = ticks(), period = tpms * ms;
+    uint32_t steps, n;
+
+    if (!timers[timer]) {
+        timers[timer] = tf;
+        return 1;
+    }
+    if (tf - timers[timer] < period)
+        return 0;
+    steps = (tf - timers[timer]) / period;
+    if (steps > MAX_CATCH_UP) {
+        dropped_steps[timer] += steps - MAX_CATCH_UP;
+        timers[timer] += (steps - MAX_CATCH_UP) * period;
+        steps = MAX_CATCH_UP;
+    }
+    late_steps[timer] += steps - 1;
+    for (n = 0; n < steps; n++) {
+        timers[timer] += period;
+        if (lateness)
+            histogram_add(lateness, tf - timers[timer]);
+    }
+    return steps;
+}
+
+/* Return true if at least ms milliseconds have elapsed since the first call
+ * for this timer and reset the timer. */
+static bool wait(enum timer timer, uint32_t ms)
+{
+    if (timers[timer]) {
+        if (ticks() - timers[timer] >= tpms * ms) {
+            timers[timer] = 0;
+            return true;
+        } else return false;
+    } else {
+        timers[timer] = ticks();
+        return false;
+    }
+}
+
+/* Return the number of milliseconds, rounded up, until interval() or wait()
+ * will return true for this timer, or 0 if it already would. */
+static uint32_t remaining(enum timer timer, uint32_t ms)
+{
+    uint64_t elapsed = ticks() - timers[timer];
+    if (elapsed >= tpms * ms)
+        return 0;
+    return (tpms * ms - elapsed + tpms - 1) / tpms;
+}
+
+/* Ticks spent sleeping in idle() and in total since idle_since, and the
+ * percentage of time spent sleeping in the last full second */
+uint64_t idle_ticks = 0, idle_since = 0;
+uint32_t idle_percent = 0;
+
+/* Microseconds from program start until the first frame of the game was on
+ * screen */
+uint32_t startup_us = 0;
+
+/* Sleep until a key is pressed or ms milliseconds have passed, and account
+ * for the time spent sleeping. */
+static void rest(uint32_t ms)
+{
+    uint64_t t = ticks();
+    if (!idle_since)
+        idle_since = t;
+    idle(ms);
+    idle_ticks += ticks() - t;
+    t = ticks();
+    if (t - idle_since >= 1000 * tpms) {
+        idle_percent = idle_ticks * 100 / (t - idle_since);
+        idle_ticks = 0;
+        idle_since = t;
+    }
+}
+
+/* Sideways movement. Neither the firmware nor a terminal reports key
+ * releases: a held key just arrives again at the keyboard's repeat rate after
+ * the keyboard's repeat delay (at most REPEAT_DELAY). Every press moves the
+ * tetrimino once, until two presses of the same key arrive less than
+ * REPEAT_GAP apart, which only a held key does. From then on the key counts
+ * as held, and the tetrimino moves on the game clock instead: das
+ * milliseconds after the first press, then every arr milliseconds (all the
+ * way at once if arr is 0). It keeps moving only as far ahead of the last
+ * repeat as the gap between repeats, so it stops about when the key is
+ * released. */
+#define REPEAT_DELAY (1000)
+#define REPEAT_GAP (100)
+
+uint32_t das = 167, arr = 33;
+
+struct shift {
+    int key;          /* KEY_LEFT or KEY_RIGHT, 0 if none */
+    bool held;
+    uint64_t pressed; /* First press */
+    uint64_t seen;    /* Last press or repeat */
+    uint64_t gap;     /* Between the last two repeats */
+    uint64_t next;    /* Next move while held */
+} shift = {0};
+
+/* Return true if this press of KEY_LEFT or KEY_RIGHT should move the
+ * tetrimino right away. */
+static bool shift_press(int key)
+{
+    uint64_t t = ticks();
+    if (key != shift.key || t - shift.seen > tpms * REPEAT_DELAY)
+        shift.pressed = t;
+    if (key != shift.key || t - shift.seen > tpms * REPEAT_GAP) {
+        shift.key = key;
+        shift.held = false;
+    } else if (!shift.held) {
+        shift.held = true;
+        shift.next = shift.pressed + tpms * das;
+        if (shift.next < t)
+            shift.next = t;
+    }
+    shift.gap = t - shift.seen;
+    shift.seen = t;
+    return !shift.held;
+}
+
+/* Return the number of times the held key, shift.key, should move the
+ * tetrimino now. */
+static uint32_t shift_update(void)
+{
+    uint64_t t = ticks();
+    uint32_t moves = 0;
+
+    if (!shift.held)
+        return 0;
+    if (t - shift.seen > 2 * shift.gap) {
+        shift.held = false;
+        shift.key = 0;
+        return 0;
+    }
+    while (t >= shift.next && shift.next - shift.seen <= shift.gap * 5 / 4) {
+        if (!arr)
+            return WELL_WIDTH;
+        moves++;
+        shift.next += tpms * arr;
+    }
+    return moves;
+}
+
+/* Return the number of milliseconds, rounded up, until shift_update() has
+ * something to do, or ms if that is longer. */
+static uint32_t shift_remaining(uint32_t ms)
+{
+    uint64_t t = ticks(), due;
+    if (!shift.held)
+        return ms;
+    due = shift.seen + 2 * shift.gap + 1;
+    if (shift.next - shift.seen <= shift.gap * 5 / 4 && shift.next < due)
+        due = shift.next;
+    if (t >= due)
+        return 0;
+    if (due - t >= tpms * ms)
+        return ms;
+    return (due - t + tpms - 1) / tpms;
+}
+
+/* Video Output */
+
+enum color {
+    BLACK,
+    BLUE,
+    GREEN,
+    CYAN,
+    RED,
+    MAGENTA,
+    BROWN,
+    GRAY,
+    BRIGHT,
+    WHITE
+};
+
+#define TERM_BLACK        0x00
+#define TERM_BLUE         0x01
+#define TERM_GREEN        0x02
+#define TERM_CYAN         0x03
+#define TERM_RED          0x04
+#define TERM_MAGENTA      0x05
+#define TERM_BROWN        0x06
+#define TERM_LIGHTGRAY    0x07
+#define TERM_BRIGHT       0x08
+#define TERM_DARKGRAY     0x08
+#define TERM_LIGHTBLUE    0x09
+#define TERM_LIGHTGREEN   0x0A
+#define TERM_LIGHTCYAN    0x0B
+#define TERM_LIGHTRED     0x0C
+#define TERM_LIGHTMAGENTA 0x0D
+#define TERM_YELLOW       0x0E
+#define TERM_WHITE        0x0F
+
+#define TERM_BACKGROUND_BLACK     0x00
+#define TERM_BACKGROUND_BLUE      0x10
+#define TERM_BACKGROUND_GREEN     0x20
+#define TERM_BACKGROUND_CYAN      0x30
+#define TERM_BACKGROUND_RED       0x40
+#define TERM_BACKGROUND_MAGENTA   0x50
+#define TERM_BACKGROUND_BROWN     0x60
+#define TERM_BACKGROUND_LIGHTGRAY 0x70
+
+#define TERM_TEXT_ATTR(fg, bg)    ((fg) | ((bg)))
+
+uintn_t color_fg[10] = 
+{
+    TERM_BLACK,
+    TERM_BLUE,
+    TERM_GREEN,
+    TERM_CYAN,
+    TERM_RED,
+    TERM_MAGENTA,
+    TERM_BROWN,
+    TERM_LIGHTGRAY,
+    TERM_WHITE
+};
+
+uintn_t color_bg[10] = 
+{
+    TERM_BACKGROUND_BLACK,
+    TERM_BACKGROUND_BLUE,
+    TERM_BACKGROUND_GREEN,
+    TERM_BACKGROUND_CYAN,
+    TERM_BACKGROUND_RED,
+    TERM_BACKGROUND_MAGENTA,
+    TERM_BACKGROUND_BROWN,
+    TERM_BACKGROUND_LIGHTGRAY,
+    TERM_BACKGROUND_LIGHTGRAY,
+    TERM_BACKGROUND_BLACK
+};
+
+/* Shadow screen buffer. Drawing functions only write (character, attribute)
+ * cells into screen; present() compares it against the cells last sent to the
+ * console and outputs the changed ones, so a frame that repaints the whole
+ * well costs firmware calls only for the cells that actually differ. */
+struct cell screen[ROWS][COLS];
+/* An attr of 0xFF is never produced by TERM_TEXT_ATTR and marks a cell whose
+ * console contents are unknown. */
+struct cell shown[ROWS][COLS];
+/* Rows of screen written since the last present() */
+bool dirty[ROWS];
+
+/* Number of firmware console calls made by the last present() that output
+ * anything, by present() calls in total, and by the current present(). */
+uint32_t frame_fw_calls = 0, total_fw_calls = 0, fw_calls = 0;
+
+/* Display a character at x, y in fg foreground color and bg background color.
+ */
+static void _putc(uint8_t x, uint8_t y, enum color fg, enum color bg, char c)
+{
+    uint8_t attr = TERM_TEXT_ATTR(color_fg[fg], color_bg[bg]);
+    if (x >= COLS || y >= ROWS)
+        return;
+    if (screen[y][x].c != (uint8_t) c || screen[y][x].attr != attr) {
+        screen[y][x].c = c;
+        screen[y][x].attr = attr;
+        dirty[y] = true;
+    }
+}
+
+/* Forget what the console shows so that the next present() outputs every
+ * cell. */
+static void invalidate(void)
+{
+    uint8_t x, y;
+    for (y = 0; y < ROWS; y++) {
+        for (x = 0; x < COLS; x++)
+            shown[y][x].attr = 0xFF;
+        dirty[y] = true;
+    }
+}
+
+/* Output the cells of screen that differ from shown through the console and
+ * record them as shown. */
+static void present(void)
+{
+    uint8_t x, y, x0, x1, end;
+
+    fw_calls = 0;
+    for (y = 0; y < ROWS; y++) {
+        if (!dirty[y])
+            continue;
+        dirty[y] = false;
+        /* Never output the bottom right cell, writing it scrolls some text
+         * consoles. */
+        end = y == ROWS - 1 ? COLS - 1 : COLS;
+        for (x0 = 0; x0 < end && !changed(x0, y); x0++)
+            ;
+        if (x0 == end)
+            continue;
+        for (x1 = end; !changed(x1 - 1, y); x1--)
+            ;
+        console_row(y, x0, x1);
+        for (x = x0; x < x1; x++)
+            shown[y][x] = screen[y][x];
+    }
+    console_end();
+
+    if (fw_calls)
+        frame_fw_calls = fw_calls;
+    total_fw_calls += fw_calls;
+}
+
+/* Display a string starting at x, y in fg foreground color and bg background
+ * color. Characters in the string are not interpreted (e.g \n, \b, \t, etc.).
+ * */
+static void _puts(uint8_t x, uint8_t y, enum color fg, enum color bg, const char *s)
+{
+    for (; *s; s++, x++)
+        _putc(x, y, fg, bg, *s);
+}
+
+/* Clear the screen to bg backround color. */
+static void clear(enum color bg)
+{
+    uint8_t x, y;
+    for (y = 0; y < ROWS; y++)
+        for (x = 0; x < COLS; x++)
+            _putc(x, y, bg, bg, ' ');
+}
+
+/* PC Speaker */
+
+/* A note of hz hertz (0 for a rest) lasting ms milliseconds */
+struct note {
+    uint16_t hz, ms;
+};
+
+/* Music: Mario Bros. Mushroom Powerup */
+static const struct note intro[] = {
+    {523, 35},
+    {392, 35},
+    {523, 35},
+    {659, 35},
+    {784, 35},
+    {1047, 35},
+    {784, 35},
+    {415, 35},
+    {523, 35},
+    {622, 35},
+    {831, 35},
+    {622, 35},
+    {831, 35},
+    {1046, 35},
+    {1244, 35},
+    {1661, 35},
+    {1244, 35},
+    {466, 35},
+    {587, 35},
+    {698, 35},
+    {932, 35},
+    {1195, 35},
+    {1397, 35},
+    {1865, 35},
+    {1397, 35},
+};
+
+static const struct note level_up_tune[] = {
+    {400, 120}, {500, 120}, {600, 120}, {800, 120},
+};
+
+/* U Can't Touch This  Artist: MC Hammer Author: Paolo Montesel (@kenoph) */
+/* 147 2 130 1 123 1 110 1 440 1 440 1 82 1 98 1 392 1 392 1 123 1 110 1 440 1 */
+static const struct note game_over_tune[] = {
+    {147, 400}, {130, 200}, {123, 200}, {110, 200}, {440, 200}, {440, 200},
+    {82, 200}, {98, 200}, {392, 200}, {392, 200}, {123, 200}, {110, 200},
+    {440, 200},
+};
+
+/* Notes waiting to be played, as a ring buffer, and the time the note being
+ * played ends (0 if the speaker is silent). sequence() starts each note when
+ * the one before it ends, so nothing waits for the music. */
+#define NOTE_QUEUE (64)
+struct note notes[NOTE_QUEUE];
+uint8_t notes_head = 0, notes_tail = 0;
+uint64_t note_end = 0;
+
+/* Queue a note. Notes that do not fit are dropped, and so is everything
+ * while a replay is played back as fast as possible. */
+static void speaker_play(uint32_t hz, uint32_t ms)
+{
+    if (playback == PLAYBACK_FAST)
+        return;
+    uint8_t tail = (notes_tail + 1) % NOTE_QUEUE;
+    if (tail == notes_head)
+        return;
+    notes[notes_tail].hz = hz;
+    notes[notes_tail].ms = ms;
+    notes_tail = tail;
+}
+
+static void speaker_tune(const struct note tune[], uint32_t len)
+{
+    uint32_t i;
+    for (i = 0; i < len; i++)
+        speaker_play(tune[i].hz, tune[i].ms);
+}
+
+/* Play a sound effect, unless music is playing. */
+static void speaker_effect(uint32_t hz, uint32_t ms)
+{
+    if (!note_end && notes_head == notes_tail)
+        speaker_play(hz, ms);
+}
+
+/* Drop the queued notes and silence the speaker. */
+static void speaker_stop(void)
+{
+    notes_head = notes_tail = 0;
+    note_end = 0;
+    speaker_off();
+}
+
+static bool speaker_busy(void)
+{
+    return note_end || notes_head != notes_tail;
+}
+
+/* Start the next note if the current one has ended, or silence the speaker
+ * if there is none. */
+static void sequence(void)
+{
+    uint64_t t = ticks();
+    if (note_end && t < note_end)
+        return;
+    if (notes_head == notes_tail) {
+        if (note_end)
+            speaker_stop();
+        return;
+    }
+
+    /* The note starts when the previous one was due to end rather than now,
+     * so that being called late does not stretch the music, unless it is so
+     * late that the whole note would already be over. */
+    struct note *note = &notes[notes_head];
+    notes_head = (notes_head + 1) % NOTE_QUEUE;
+    if (!note_end || t - note_end >= tpms * note->ms)
+        note_end = t;
+    note_end += tpms * note->ms;
+    if (note->hz)
+        speaker_on(note->hz);
+    else
+        speaker_off();
+}
+
+/* Return the number of milliseconds, rounded up, until sequence() has
+ * something to do, or ms if that is longer. */
+static uint32_t sequence_remaining(uint32_t ms)
+{
+    uint64_t t = ticks();
+    if (!note_end)
+        return notes_head != notes_tail ? 0 : ms;
+    if (t >= note_end)
+        return 0;
+    if (note_end - t >= tpms * ms)
+        return ms;
+    return (note_end - t + tpms - 1) / tpms;
+}
+
+/* Formatting */
+
+/* Format n in radix r (2-16) as a w length string, or with as many digits as
+ * it takes if w is 0. */
+static char *itoa(uint32_t n, uint8_t r, uint8_t w)
+{
+    static const char d[16] = "0123456789ABCDEF";
+    static char s[34];
+    s[33] = 0;
+    uint8_t i = 33;
+    do {
+        i--;
+        s[i] = d[n % r];
+        n /= r;
+    } while (w ? i > 33 - w : n);
+    return (char *) (s + i);
+}
+
+#define TITLE_X (COLS / 2 - 9)
+#define TITLE_Y (ROWS / 2 - 1)
+
+/* Draw about information in the centre. Shown on boot and pause. */
+static void draw_about(void) {
+    _puts(TITLE_X,      TITLE_Y,     BLACK,  RED,     "   ");
+    _puts(TITLE_X + 3,  TITLE_Y,     BLACK,  MAGENTA, "   ");
+    _puts(TITLE_X + 6,  TITLE_Y,     BLACK,  BLUE,    "   ");
+    _puts(TITLE_X + 9,  TITLE_Y,     BLACK,  GREEN,   "   ");
+    _puts(TITLE_X + 12, TITLE_Y,     BLACK,  BROWN,   "   ");
+    _puts(TITLE_X + 15, TITLE_Y,     BLACK,  CYAN,    "   ");
+    _puts(TITLE_X,      TITLE_Y + 1, GRAY,   RED,     " T ");
+    _puts(TITLE_X + 3,  TITLE_Y + 1, GRAY,   MAGENTA, " E ");
+    _puts(TITLE_X + 6,  TITLE_Y + 1, GRAY,   BLUE,    " T ");
+    _puts(TITLE_X + 9,  TITLE_Y + 1, GRAY,   GREEN,   " R ");
+    _puts(TITLE_X + 12, TITLE_Y + 1, GRAY,   BROWN,   " I ");
+    _puts(TITLE_X + 15, TITLE_Y + 1, GRAY,   CYAN,    " S ");
+    _puts(TITLE_X,      TITLE_Y + 2, BLACK,  RED,     "   ");
+    _puts(TITLE_X + 3,  TITLE_Y + 2, BLACK,  MAGENTA, "   ");
+    _puts(TITLE_X + 6,  TITLE_Y + 2, BLACK,  BLUE,    "   ");
+    _puts(TITLE_X + 9,  TITLE_Y + 2, BLACK,  GREEN,   "   ");
+    _puts(TITLE_X + 12, TITLE_Y + 2, BLACK,  BROWN,   "   ");
+    _puts(TITLE_X + 15, TITLE_Y + 2, BLACK,  CYAN,    "   ");
+
+    _puts(0, ROWS - 1, GRAY,  BLACK,
+         "TETRIS for UEFI");
+}
+
+#define WELL_X (COLS / 2 - WELL_WIDTH)
+
+#define PREVIEW_X (COLS * 3/4 + 1)
+#define PREVIEW_Y (2)
+
+#define STATUS_X (COLS * 3/4)
+#define STATUS_Y (ROWS / 2 - 4)
+
+#define SCORE_X STATUS_X
+#define SCORE_Y (ROWS / 2 - 1)
+
+#define LEVEL_X SCORE_X
+#define LEVEL_Y (SCORE_Y + 4)
+
+/* Draw the well, current tetrimino, its ghost, the preview tetrimino, the
+ * status, score and level indicators. Each well/tetrimino cell is drawn one
+ * screen-row high and two screen-columns wide. The top two rows of the well
+ * are hidden. Rows in the cleared_rows array are drawn as white rather than
+ * their actual colors. */
+static void draw(void)
+{
+    const struct current *c = &tetris.current;
+    const int8_t *cleared = tetris.cleared_rows;
+    const struct offset *cell;
+    uint8_t x, y, n;
+
+    if (paused) {
+        draw_about();
+        goto status;
+    }
+
+    /* Border */
+    for (y = 2; y < WELL_HEIGHT; y++) {
+        _putc(WELL_X - 1,            y, BLACK, BRIGHT, ' ');
+        _putc(COLS / 2 + WELL_WIDTH, y, BLACK, BRIGHT, ' ');
+    }
+    for (x = 0; x < WELL_WIDTH * 2 + 2; x++)
+        _putc(WELL_X + x - 1, WELL_HEIGHT, BLACK, BRIGHT, ' ');
+
+    /* Well */
+    for (y = 0; y < 2; y++)
+        for (x = 0; x < WELL_WIDTH; x++)
+            _puts(WELL_X + x * 2, y, BLACK, BLACK, "  ");
+    for (y = 2; y < WELL_HEIGHT; y++)
+        for (x = 0; x < WELL_WIDTH; x++)
+            if (tetris.well[y][x])
+                if (cleared[0] == y || cleared[1] == y ||
+                    cleared[2] == y || cleared[3] == y)
+                    _puts(WELL_X + x * 2, y, BLACK, BRIGHT, "  ");
+                else
+                    _puts(WELL_X + x * 2, y, BLACK, tetris.well[y][x], "  ");
+            else
+                _puts(WELL_X + x * 2, y, BROWN, BLACK, "  "); /* FIXME */
+
+    /* Ghost */
+    if (!tetris.game_over)
+        for (n = 0; n < 4; n++) {
+            cell = &TETRIS_CELLS[c->i][c->r][n];
+            _puts(WELL_X + (c->x + cell->x) * 2, c->g + cell->y,
+                  TETRIS_COLOR[c->i], BLACK, "::");
+        }
+
+    /* Current */
+    for (n = 0; n < 4; n++) {
+        cell = &TETRIS_CELLS[c->i][c->r][n];
+        _puts(WELL_X + (c->x + cell->x) * 2, c->y + cell->y, BLACK,
+              TETRIS_COLOR[c->i], "  ");
+    }
+
+    /* Preview */
+    for (y = 0; y < 4; y++)
+        for (x = 0; x < 4; x++)
+            _puts(PREVIEW_X + x * 2, PREVIEW_Y + y, BLACK, BLACK, "  ");
+    for (n = 0; n < 4; n++) {
+        cell = &TETRIS_CELLS[tetris.bag[c->p]][0][n];
+        _puts(PREVIEW_X + cell->x * 2, PREVIEW_Y + cell->y, BLACK,
+              TETRIS_COLOR[tetris.bag[c->p]], "  ");
+    }
+
+status:
+    if (paused)
+        _puts(STATUS_X + 2, STATUS_Y, BRIGHT, BLACK, "PAUSED");
+    if (tetris.game_over)
+        _puts(STATUS_X, STATUS_Y, BRIGHT, BLACK, "GAME OVER");
+
+    /* Score */
+    _puts(SCORE_X + 2, SCORE_Y, GREEN, BLACK, "SCORE");
+    _puts(SCORE_X, SCORE_Y + 2, BRIGHT, BLACK, itoa(tetris.score, 10, 10));
+
+    /* Level */
+    _puts(LEVEL_X + 2, LEVEL_Y, GREEN, BLACK, "LEVEL");
+    _puts(LEVEL_X, LEVEL_Y + 2, BRIGHT, BLACK, itoa(tetris.level, 10, 10));
+}
+
+/* Draw the samples and percentiles of h from row y of the debug overlay. */
+static void histogram_draw(uint8_t y, const struct histogram *h)
+{
+    static const uint8_t p[3] = {50, 95, 99};
+    uint8_t i;
+    _puts(0,  y, BRIGHT, BLACK, h->name);
+    _puts(0,  y + 1, GRAY,  BLACK, "samples:");
+    _puts(10, y + 1, GREEN, BLACK, itoa(h->samples, 10, 10));
+    for (i = 0; i < 3; i++) {
+        _puts(0,  y + 2 + i, GRAY, BLACK, "p   us:");
+        _puts(1,  y + 2 + i, GRAY, BLACK, itoa(p[i], 10, 2));
+        _puts(10, y + 2 + i, GREEN, BLACK, itoa(percentile(h, p[i]), 10, 10));
+    }
+    _puts(0,  y + 5, GRAY,  BLACK, "max us:");
+    _puts(10, y + 5, GREEN, BLACK, itoa(h->max, 10, 10));
+}
+
+#ifdef PROFILE
+/* Profile sections. Each keeps the minimum, total and maximum over the
+ * current second, and the last full second is what the overlay shows. The
+ * number of firmware calls per frame is kept the same way. */
+struct profile {
+    uint64_t min, max, sum;
+    uint32_t count;
+};
+
+struct profile profile[SECTION__LENGTH + 1], profile_shown[SECTION__LENGTH + 1];
+uint64_t profile_since = 0;
+
+static const char *const section_names[SECTION__LENGTH + 1] = {
+    "update", "ghost", "draw", "clear", "scan", "fw", "search", "fw/frm"
+};
+
+static void profile_count(struct profile *p, uint64_t n)
+{
+    if (!p->count || n < p->min)
+        p->min = n;
+    if (n > p->max)
+        p->max = n;
+    p->sum += n;
+    p->count++;
+}
+
+void profile_add(enum section section, uint64_t t)
+{
+    profile_count(&profile[section], t);
+}
+
+/* Count the firmware calls made by a frame, and start a new second if the
+ * current one is over. */
+static void profile_frame(uint32_t calls)
+{
+    uint64_t t = ticks();
+    profile_count(&profile[SECTION__LENGTH], calls);
+    if (!profile_since)
+        profile_since = t;
+    if (t - profile_since >= 1000 * tpms) {
+        memcpy(profile_shown, profile, sizeof(profile));
+        memset(profile, 0, sizeof(profile));
+        profile_since = t;
+    }
+}
+
+/* Format n ticks as nanoseconds, at most 6 digits. */
+static char *profile_ns(uint64_t n)
+{
+    n = n * 1000000 / tpms;
+    return itoa(n < 999999 ? n : 999999, 10, 6);
+}
+
+static void profile_draw(void)
+{
+    const struct profile *p;
+    uint8_t i;
+    _puts(0,  0, BRIGHT, BLACK, "ns");
+    _puts(10, 0, BRIGHT, BLACK, "min");
+    _puts(17, 0, BRIGHT, BLACK, "avg");
+    _puts(24, 0, BRIGHT, BLACK, "max");
+    for (i = 0; i < SECTION__LENGTH; i++) {
+        p = &profile_shown[i];
+        _puts(0,  1 + i, GRAY,  BLACK, section_names[i]);
+        _puts(7,  1 + i, GREEN, BLACK, profile_ns(p->min));
+        _puts(14, 1 + i, GREEN, BLACK,
+              profile_ns(p->count ? p->sum / p->count : 0));
+        _puts(21, 1 + i, GREEN, BLACK, profile_ns(p->max));
+    }
+    p = &profile_shown[SECTION__LENGTH];
+    _puts(0,  2 + i, GRAY,  BLACK, section_names[i]);
+    _puts(7,  2 + i, GREEN, BLACK, itoa(p->min, 10, 6));
+    _puts(14, 2 + i, GREEN, BLACK, itoa(p->count ? p->sum / p->count : 0,
+                                        10, 6));
+    _puts(21, 2 + i, GREEN, BLACK, itoa(p->max, 10, 6));
+    _puts(0,  4 + i, GRAY,  BLACK, "table hit %:");
+    _puts(14, 4 + i, GREEN, BLACK, itoa(table.lookups ?
+                                        table.hits * 100 / table.lookups : 0,
+                                        10, 3));
+}
+#endif
+
+/* Append s to the end of the string in line. */
+static void cat(char *line, const char *s)
+{
+    while (*line)
+        line++;
+    while ((*line++ = *s++))
+        ;
+}
+
+/* Print the samples and percentiles of h as one line. */
+static void histogram_print(const struct histogram *h)
+{
+    char line[128] = "";
+    cat(line, h->name);
+    cat(line, ": ");
+    cat(line, itoa(h->samples, 10, 0));
+    cat(line, " samples, p50 ");
+    cat(line, itoa(percentile(h, 50), 10, 0));
+    cat(line, " us, p95 ");
+    cat(line, itoa(percentile(h, 95), 10, 0));
+    cat(line, " us, p99 ");
+    cat(line, itoa(percentile(h, 99), 10, 0));
+    cat(line, " us, max ");
+    cat(line, itoa(h->max, 10, 0));
+    cat(line, " us");
+    print(line);
+}
+
+/* Return true for keys that change what is shown or who plays, but not the
+ * game itself. They are left out of replays. */
+static bool ui_key(int key)
+{
+    return key == KEY_A || key == KEY_D || key == KEY_H || key == KEY_S ||
+           key == KEY_P;
+}
+
+/* Autoplay: when on, the autoplayer picks a placement for each new tetrimino
+ * and plays the keys to get it there, one every ai_step() milliseconds. */
+bool autoplay = false;
+struct placement target;
+uint32_t target_locks = 0; /* Value of locks the target was found for */
+bool target_found = false;
+
+/* Microseconds the last search and the slowest one took */
+uint32_t search_us = 0, search_max_us = 0;
+
+/* Fast enough to place a tetrimino well within one gravity interval, slow
+ * enough to watch at low levels */
+static uint32_t ai_step(void)
+{
+    uint32_t ms = tetris.speed / 10;
+    return ms < 1 ? 1 : ms > 50 ? 50 : ms;
+}
+
+/* Times the lock delay was started over for the current tetrimino, which is
+ * the one spawned after lock_resets_locks tetriminos were locked */
+uint32_t lock_resets = 0, lock_resets_locks = 0;
+
+/* Start the lock delay over, if it is running, after the current tetrimino
+ * moved or rotated, unless that has been done LOCK_RESETS times already. */
+static void lock_reset(void)
+{
+    if (lock_resets_locks != tetris.locks) {
+        lock_resets_locks = tetris.locks;
+        lock_resets = 0;
+    }
+    if (timers[TIMER_LOCK] && lock_resets < LOCK_RESETS) {
+        timers[TIMER_LOCK] = ticks();
+        lock_resets++;
+    }
+}
+
+/* Act on a key, or on one of the pseudo-keys for what the main loop does on
+ * its own, and record it for the replay if it changes the game. Return false
+ * if the game should end. */
+static bool handle_key(int key)
+{
+    if (!playback && !ui_key(key))
+        replay_record((ticks() - game_start) / tpms, key);
+
+    switch(key) {
+    case KEY_D:
+        debug = (debug + 1) % PAGE__LENGTH;
+        check_ghost = debug != PAGE_OFF;
+        if (debug)
+            help = statistics = false;
+        clear(BLACK);
+        break;
+    case KEY_H:
+        help = !help;
+        if (help) {
+            debug = PAGE_OFF;
+            check_ghost = statistics = false;
+        }
+        clear(BLACK);
+        break;
+    case KEY_S:
+        statistics = !statistics;
+        if (statistics) {
+            debug = PAGE_OFF;
+            check_ghost = help = false;
+        }
+        clear(BLACK);
+        break;
+    case KEY_A:
+        if (playback)
+            break;
+        autoplay = !autoplay;
+        target_found = false;
+        break;
+    case KEY_R:
+    case KEY_ESC:
+        return false;
+    case KEY_LEFT:
+        if (move(&tetris, -1, 0))
+            lock_reset();
+        break;
+    case KEY_RIGHT:
+        if (move(&tetris, 1, 0))
+            lock_reset();
+        break;
+    case KEY_DOWN:
+        soft_drop(&tetris);
+        break;
+    case KEY_UP:
+    case KEY_SPACE:
+        if (rotate(&tetris)) {
+            speaker_effect(1200, 10);
+            lock_reset();
+        }
+        break;
+    case KEY_ENTER:
+        drop(&tetris);
+        break;
+    case KEY_P:
+        if (tetris.game_over)
+            break;
+        clear(BLACK);
+        paused = !paused;
+        break;
+    case EVENT_UPDATE: {
+        uint64_t t = ticks();
+        PROFILE_BEGIN(SECTION_UPDATE);
+        update(&tetris);
+        PROFILE_END(SECTION_UPDATE);
+        histogram_add(&update_time, ticks() - t);
+        break;
+    }
+    case EVENT_CLEAR: {
+        PROFILE_BEGIN(SECTION_CLEAR);
+        clear_rows(&tetris);
+        PROFILE_END(SECTION_CLEAR);
+        break;
+    }
+    case EVENT_LOCK:
+        lock_down(&tetris);
+        break;
+    }
+    return true;
+}
+
+/* Play the next key towards the target placement, searching for one first if
+ * the tetrimino is new. A key that does not get the tetrimino any closer,
+ * because something is in the way, is followed by a drop. */
+static void autoplay_step(void)
+{
+    struct board board;
+    uint64_t t;
+    uint8_t r = tetris.current.r;
+    int8_t x = tetris.current.x;
+    int key;
+
+    if (!target_found || target_locks != tetris.locks) {
+        t = ticks();
+        board_load(&board, &tetris);
+        PROFILE_BEGIN(SECTION_SEARCH);
+        target_found = ai_lookahead(&board, tetris.current.i,
+                                    tetris.bag[tetris.current.p],
+                                    tetris.current.y, &default_weights, true,
+                                    table_ready ? &table : NULL, &target);
+        PROFILE_END(SECTION_SEARCH);
+        target_locks = tetris.locks;
+        search_us = (ticks() - t) * 1000 / tpms;
+        if (search_us > search_max_us)
+            search_max_us = search_us;
+        if (!target_found)
+            return;
+    }
+
+    if (tetris.current.r != target.r)
+        key = KEY_UP;
+    else if (tetris.current.x > target.x)
+        key = KEY_LEFT;
+    else if (tetris.current.x < target.x)
+        key = KEY_RIGHT;
+    else
+        key = KEY_ENTER;
+    handle_key(key);
+    if (key != KEY_ENTER && tetris.current.r == r && tetris.current.x == x)
+        handle_key(KEY_ENTER);
+}
+
+void game(void)
+{
+    uint32_t recorded_score = 0, frames = 0;
+    uint32_t next_ms = 0;
+    int next_key = 0;
+    bool pending = false;
+
+    if (playback) {
+        uint16_t recorded_gravity;
+        if (!replay_load(REPLAY_FILE, &seed, &recorded_gravity,
+                         &recorded_score)) {
+            print("No replay to play back in " REPLAY_FILE);
+            return;
+        }
+        pending = replay_next(&next_ms, &next_key);
+        gravity = recorded_gravity;
+    }
+
+    paused = false;
+    calibrate();
+    table_ready = table_init(&table);
+    evaluator = evaluator_fastest();
+    console_init();
+    invalidate();
+    clear(BLACK);
+    draw_about();
+    present();
+    speaker_tune(intro, sizeof(intro) / sizeof(*intro));
+
+    if (!seed)
+        seed = ticks();
+    if (gravity > GRAVITY_20G)
+        gravity = GRAVITY_20G;
+    reset(&tetris, seed, gravity);
+    if (!playback)
+        replay_start(seed, gravity);
+    game_start = ticks();
+    ghost(&tetris);
+    clear(BLACK);
+    draw();
+
+    bool finale = false;
+    uint32_t heard_locks = 0, moves, steps;
+loop:
+    if (!debug && !statistics)
+        help = true;
+
+    if (debug == PAGE_STATE) {
+        uint32_t i;
+        _puts(0,  0, GRAY,   BLACK, "RTC sec:");
+        _puts(10, 0, GREEN,  BLACK, itoa(rtcs(), 16, 2));
+        _puts(0,  1, GRAY,   BLACK, "ticks/ms:");
+        _puts(10, 1, GREEN,  BLACK, itoa(tpms, 10, 10));
+        _puts(0,  2, GRAY,   BLACK, "key:");
+        _puts(10, 2, GREEN,  BLACK, itoa(last_key, 16, 2));
+        _puts(0,  3, GRAY,   BLACK, "i,r,p:");
+        _puts(10, 3, GREEN,  BLACK, itoa(tetris.current.i, 10, 1));
+        _putc(11, 3, GREEN,  BLACK, ',');
+        _puts(12, 3, GREEN,  BLACK, itoa(tetris.current.r, 10, 1));
+        _putc(13, 3, GREEN,  BLACK, ',');
+        _puts(14, 3, GREEN,  BLACK, itoa(tetris.current.p, 10, 1));
+        _puts(0,  4, GRAY,   BLACK, "x,y,g:");
+        _puts(10, 4, GREEN,  BLACK, itoa(tetris.current.x, 10, 3));
+        _putc(13, 4, GREEN,  BLACK, ',');
+        _puts(14, 4, GREEN,  BLACK, itoa(tetris.current.y, 10, 3));
+        _putc(17, 4, GREEN,  BLACK, ',');
+        _puts(18, 4, GREEN,  BLACK, itoa(tetris.current.g, 10, 3));
+        _puts(0,  5, GRAY,   BLACK, "bag:");
+        for (i = 0; i < 7; i++)
+            _puts(10 + i * 2, 5, GREEN, BLACK, itoa(tetris.bag[i], 10, 1));
+        _puts(0,  6, GRAY,   BLACK, "speed/g:");
+        _puts(10, 6, GREEN,  BLACK, itoa(tetris.speed, 10, 5));
+        _putc(15, 6, GREEN,  BLACK, '/');
+        _puts(16, 6, GREEN,  BLACK, itoa(tetris.gravity, 10, 5));
+        _puts(0,  7, GRAY,   BLACK, "grav l/d:");
+        _puts(10, 7, GREEN,  BLACK, itoa(late_steps[TIMER_UPDATE], 10, 5));
+        _putc(15, 7, GREEN,  BLACK, '/');
+        _puts(16, 7, GREEN,  BLACK, itoa(dropped_steps[TIMER_UPDATE], 10, 5));
+        _puts(0,  8, GRAY,   BLACK, "ai l/d:");
+        _puts(10, 8, GREEN,  BLACK, itoa(late_steps[TIMER_AI], 10, 5));
+        _putc(15, 8, GREEN,  BLACK, '/');
+        _puts(16, 8, GREEN,  BLACK, itoa(dropped_steps[TIMER_AI], 10, 5));
+        _puts(0,  9, GRAY,   BLACK, "fw calls:");
+        _puts(10, 9, GREEN,  BLACK, itoa(frame_fw_calls, 10, 10));
+        _puts(0, 10, GRAY,   BLACK, "output:");
+        _puts(10, 10, GREEN, BLACK, console_name());
+        _puts(0, 11, GRAY,   BLACK, "ghost err:");
+        _puts(10, 11, GREEN, BLACK, itoa(tetris.ghost_errors, 10, 5));
+        _putc(15, 11, GREEN, BLACK, '/');
+        _puts(16, 11, GREEN, BLACK, itoa(tetris.ghost_checks, 10, 10));
+        _puts(0, 12, GRAY,   BLACK, "row chk:");
+        _puts(10, 12, GREEN, BLACK, itoa(tetris.row_checks, 10, 10));
+        _puts(0, 13, GRAY,   BLACK, "row skip:");
+        _puts(10, 13, GREEN, BLACK, itoa(tetris.row_checks_skipped, 10, 10));
+        _puts(0, 14, GRAY,   BLACK, "idle %:");
+        _puts(10, 14, GREEN, BLACK, itoa(idle_percent, 10, 3));
+        _puts(0, 15, GRAY,   BLACK, "start us:");
+        _puts(10, 15, GREEN, BLACK, itoa(startup_us, 10, 10));
+        _puts(0, 16, GRAY,   BLACK, "clock:");
+        _puts(10, 16, GREEN, BLACK, calibration);
+        _puts(0, 17, GRAY,   BLACK, "input:");
+        _puts(10, 17, GREEN, BLACK, input_name());
+        _puts(0, 18, GRAY,   BLACK, "das/arr:");
+        _puts(10, 18, GREEN, BLACK, itoa(das, 10, 4));
+        _putc(14, 18, GREEN, BLACK, '/');
+        _puts(15, 18, GREEN, BLACK, itoa(arr, 10, 4));
+        _puts(0, 19, GRAY,   BLACK, "seed:");
+        _puts(10, 19, GREEN, BLACK, itoa(seed, 10, 10));
+        _puts(0, 20, GRAY,   BLACK, "search us:");
+        _puts(10, 20, GREEN, BLACK, itoa(search_us, 10, 6));
+        _putc(16, 20, GREEN, BLACK, '/');
+        _puts(17, 20, GREEN, BLACK, itoa(search_max_us, 10, 6));
+        _puts(0, 21, GRAY,   BLACK, "cpus:");
+        _puts(10, 21, GREEN, BLACK, itoa(processors(), 10, 4));
+        _puts(0, 22, GRAY,   BLACK, "tt hit %:");
+        _puts(10, 22, GREEN, BLACK, itoa(table.lookups ?
+                                         table.hits * 100 / table.lookups : 0,
+                                         10, 3));
+        _puts(0, 23, GRAY,   BLACK, "eval:");
+        _puts(10, 23, GREEN, BLACK, evaluator_names[evaluator]);
+    }
+    if (debug == PAGE_LATENCY) {
+        histogram_draw(0, &key_latency);
+        histogram_draw(7, &update_time);
+        histogram_draw(14, &gravity_late);
+    }
+#ifdef PROFILE
+    if (debug == PAGE_PROFILE)
+        profile_draw();
+#endif
+
+    if (help) {
+        _puts(1, 12, GRAY,   BLACK, "LEFT");
+        _puts(7, 12, BLUE,   BLACK, "- Move left");
+        _puts(1, 13, GRAY,   BLACK, "RIGHT");
+        _puts(7, 13, BLUE,   BLACK, "- Move right");
+        _puts(1, 14, GRAY,   BLACK, "UP");
+        _puts(7, 14, BLUE,   BLACK, "- Rotate clockwise");
+        _puts(1, 15, GRAY,   BLACK, "DOWN");
+        _puts(7, 15, BLUE,   BLACK, "- Soft drop");
+        _puts(1, 16, GRAY,   BLACK, "ENTER");
+        _puts(7, 16, BLUE,   BLACK, "- Hard drop");
+        _puts(1, 17, GRAY,   BLACK, "P");
+        _puts(7, 17, BLUE,   BLACK, "- Pause");
+        _puts(1, 18, GRAY,   BLACK, "ESC");
+        _puts(7, 18, BLUE,   BLACK, "- Exit");
+        _puts(1, 19, GRAY,   BLACK, "S");
+        _puts(7, 19, BLUE,   BLACK, "- Toggle statistics");
+        _puts(1, 20, GRAY,   BLACK, "D");
+        _puts(7, 20, BLUE,   BLACK, "- Cycle debug info");
+        _puts(1, 21, GRAY,   BLACK, "H");
+        _puts(7, 21, BLUE,   BLACK, "- Toggle help");
+        _puts(1, 22, GRAY,   BLACK, "A");
+        _puts(7, 22, BLUE,   BLACK, "- Toggle autoplay");
+    }
+
+    if (statistics) {
+        const struct offset *cell;
+        uint8_t i, n;
+        for (i = 0; i < 7; i++) {
+            for (n = 0; n < 4; n++) {
+                cell = &TETRIS_CELLS[i][0][n];
+                _puts(5 + cell->x * 2, 1 + i * 3 + cell->y, BLACK,
+                      TETRIS_COLOR[i], "  ");
+            }
+            _puts(14, 2 + i * 3, BLUE, BLACK, itoa(tetris.stats[i], 10, 10));
+        }
+    }
+
+    bool updated = false;
+
+    /* Handle every key that arrived since the last frame. */
+    int key;
+    for (;;) {
+        PROFILE_BEGIN(SECTION_SCAN);
+        key = scan();
+        PROFILE_END(SECTION_SCAN);
+        if (!key)
+            break;
+        last_key = key;
+        updated = true;
+        /* While playing back, only the keys that do not change the game
+         * work. */
+        if (playback && key != KEY_D && key != KEY_H && key != KEY_S &&
+            key != KEY_R && key != KEY_ESC)
+            continue;
+        if (autoplay && !ui_key(key) && key != KEY_R && key != KEY_ESC)
+            continue;
+        if ((key == KEY_LEFT || key == KEY_RIGHT) && !shift_press(key))
+            continue;
+        if (keys_read < KEYS_PER_FRAME)
+            key_ticks[keys_read++] = ticks();
+        if (!handle_key(key))
+            goto fail;
+    }
+
+    if (playback) {
+        /* Hand the replay's events to handle_key() when they are due: all
+         * that are due in real time, or one per frame when fast. */
+        while (pending && (playback == PLAYBACK_FAST ||
+                           ticks() - game_start >= tpms * next_ms)) {
+            if (next_key < EVENT_UPDATE && keys_read < KEYS_PER_FRAME)
+                key_ticks[keys_read++] = ticks();
+            if (!handle_key(next_key))
+                goto fail;
+            updated = true;
+            pending = replay_next(&next_ms, &next_key);
+            if (playback == PLAYBACK_FAST)
+                break;
+        }
+    } else {
+        for (moves = shift_update(); moves; moves--) {
+            handle_key(shift.key);
+            updated = true;
+        }
+
+        /* Timers stop while they have nothing to do, so that a pause is
+         * not caught up with afterwards. */
+        if (!paused && !tetris.game_over)
+            for (steps = interval(TIMER_UPDATE, tetris.speed, &gravity_late);
+                 steps && !tetris.game_over; steps--) {
+                handle_key(EVENT_UPDATE);
+                updated = true;
+            }
+        else
+            timers[TIMER_UPDATE] = 0;
+
+        /* A drop clears the rows itself, so the delay may have nothing left
+         * to wait for. */
+        if (tetris.cleared_rows[0] < 0)
+            timers[TIMER_CLEAR] = 0;
+        else if (wait(TIMER_CLEAR, CLEAR_DELAY)) {
+            handle_key(EVENT_CLEAR);
+            updated = true;
+        }
+
+        /* The lock delay runs while the tetrimino stays landed */
+        if (tetris.gravity && !paused && !tetris.game_over &&
+            landed(&tetris)) {
+            if (wait(TIMER_LOCK, LOCK_DELAY)) {
+                handle_key(EVENT_LOCK);
+                updated = true;
+            }
+        } else
+            timers[TIMER_LOCK] = 0;
+
+        if (autoplay && !paused && !tetris.game_over)
+            for (steps = interval(TIMER_AI, ai_step(), NULL);
+                 steps && !tetris.game_over; steps--) {
+                autoplay_step();
+                updated = true;
+            }
+        else
+            timers[TIMER_AI] = 0;
+    }
+
+    if (tetris.locks != heard_locks) {
+        heard_locks = tetris.locks;
+        if (tetris.cleared_rows[0] >= 0)
+            speaker_effect(880, 60);
+        else
+            speaker_effect(110, 15);
+    }
+
+    if (updated) {
+        PROFILE_BEGIN(SECTION_GHOST);
+        ghost(&tetris);
+        PROFILE_END(SECTION_GHOST);
+        PROFILE_BEGIN(SECTION_DRAW);
+        draw();
+        PROFILE_END(SECTION_DRAW);
+    }
+    present();
+    frames++;
+#ifdef PROFILE
+    profile_frame(fw_calls);
+#endif
+    for (; keys_read; keys_read--)
+        histogram_add(&key_latency, ticks() - key_ticks[keys_read - 1]);
+    if (!startup_us)
+        startup_us = (ticks() - started) * 1000 / tpms;
+
+    if (tetris.level_up) {
+        speaker_tune(level_up_tune,
+                     sizeof(level_up_tune) / sizeof(*level_up_tune));
+        tetris.level_up = 0;
+    }
+    /* The game ends once the game over tune has played out. */
+    if (tetris.game_over && !finale) {
+        finale = true;
+        speaker_stop();
+        speaker_tune(game_over_tune,
+                     sizeof(game_over_tune) / sizeof(*game_over_tune));
+    }
+    sequence();
+    if (finale && !speaker_busy())
+        goto fail;
+    if (playback && !pending)
+        goto fail;
+
+    /* Sleep until a key arrives or the next timer is due, instead of polling
+     * for either. */
+    uint32_t timeout = debug ? DEBUG_REFRESH : IDLE_TIMEOUT, ms;
+    if (playback == PLAYBACK_FAST)
+        goto loop;
+    if (playback) {
+        uint64_t elapsed = ticks() - game_start;
+        if (elapsed >= tpms * next_ms)
+            timeout = 0;
+        else if ((ms = (tpms * next_ms - elapsed + tpms - 1) / tpms) < timeout)
+            timeout = ms;
+    } else if (!paused && !tetris.game_over &&
+        (ms = remaining(TIMER_UPDATE, tetris.speed)) < timeout)
+        timeout = ms;
+    if (tetris.cleared_rows[0] >= 0 && timers[TIMER_CLEAR] &&
+        (ms = remaining(TIMER_CLEAR, CLEAR_DELAY)) < timeout)
+        timeout = ms;
+    if (timers[TIMER_LOCK] &&
+        (ms = remaining(TIMER_LOCK, LOCK_DELAY)) < timeout)
+        timeout = ms;
+    if (autoplay && !paused && !tetris.game_over &&
+        (ms = remaining(TIMER_AI, ai_step())) < timeout)
+        timeout = ms;
+    timeout = sequence_remaining(timeout);
+    timeout = shift_remaining(timeout);
+    rest(timeout);
+
+    goto loop;
+fail:
+    speaker_stop();
+    console_fini();
+    char line[128] = "seed ";
+    cat(line, itoa(seed, 10, 0));
+    cat(line, ", score ");
+    cat(line, itoa(tetris.score, 10, 0));
+    if (playback) {
+        cat(line, replay_full ? " (replay truncated, recorded game scored " :
+                                " (recorded ");
+        cat(line, itoa(recorded_score, 10, 0));
+        cat(line, "), ");
+        cat(line, itoa(replay_events, 10, 0));
+        cat(line, " events in ");
+        cat(line, itoa(frames, 10, 0));
+        cat(line, " frames, ");
+        cat(line, itoa((ticks() - game_start) / tpms, 10, 0));
+        cat(line, " ms");
+    } else {
+        uintn_t size = replay_save(REPLAY_FILE, tetris.score);
+        if (replay_full) {
+            cat(line, ", replay truncated after ");
+            cat(line, itoa(replay_events, 10, 0));
+            cat(line, " events");
+        }
+        cat(line, size ? ", replay saved to " REPLAY_FILE " (" :
+                         ", could not save replay to " REPLAY_FILE);
+        if (size) {
+            cat(line, itoa(size, 10, 0));
+            cat(line, " bytes)");
+        }
+    }
+    print(line);
+    if (key_latency.samples)
+        histogram_print(&key_latency);
+    if (update_time.samples)
+        histogram_print(&update_time);
+    if (gravity_late.samples) {
+        histogram_print(&gravity_late);
+        line[0] = 0;
+        cat(line, "gravity: ");
+        cat(line, itoa(late_steps[TIMER_UPDATE], 10, 0));
+        cat(line, " steps late, ");
+        cat(line, itoa(dropped_steps[TIMER_UPDATE], 10, 0));
+        cat(line, " dropped");
+        print(line);
+    }
+}
@@ -0,0 +1,405 @@
+/*
+ *  UEFI Tetris
+ *  Copyright (C) 2013C2014, Curtis McEnroe programble@gmail.com
+ *
+ *  Permission to use, copy, modify, and/or distribute this software
+ *  for any purpose with or without fee is hereby granted, provided 
+ *  that the above copyright notice and this permission notice
+ *  appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ *  WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL
+ *  THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR 
+ *  CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ *  LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ *  NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ *  CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "platform.h"
+
+/* Hosted platform: runs the game in a POSIX terminal using ANSI escape
+ * sequences, or with a null console that neither outputs nor reads anything,
+ * so the engine can be profiled and debugged with ordinary tools. */
+
+bool null_console = false;
+
+/* Timing */
+
+/* Ticks are CLOCK_MONOTONIC nanoseconds */
+uint64_t tpms = 1000000;
+const char *calibration = "clock_gettime";
+uint64_t started;
+
+uint64_t ticks(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void calibrate(void)
+{
+}
+
+/* Return the current second of the local time in BCD, like the RTC. */
+uint8_t rtcs(void)
+{
+    time_t t = time(NULL);
+    struct tm tm;
+    localtime_r(&t, &tm);
+    return (tm.tm_sec / 10) << 4 | tm.tm_sec % 10;
+}
+
+void stall(uintn_t us)
+{
+    struct timespec ts = { us / 1000000, us % 1000000 * 1000 };
+    nanosleep(&ts, NULL);
+}
+
+/* Keyboard Input */
+
+/* Bytes read from the terminal but not yet returned as keys */
+unsigned char input[64];
+size_t input_len = 0;
+
+static void consume(size_t n)
+{
+    memmove(input, input + n, input_len - n);
+    input_len -= n;
+}
+
+/* Translate terminal input to keys. Arrow keys arrive as ESC [ A to ESC [ D;
+ * an ESC not followed by [ is the escape key itself. */
+int scan(void)
+{
+    ssize_t n;
+    int key;
+
+    if (null_console)
+        return 0;
+    n = read(STDIN_FILENO, input + input_len, sizeof(input) - input_len);
+    if (n > 0)
+        input_len += n;
+    if (!input_len)
+        return 0;
+
+    if (input[0] == 0x1b && input_len > 1 && input[1] == '[') {
+        if (input_len < 3)
+            return 0;
+        switch (input[2]) {
+        case 'A': key = KEY_UP;    break;
+        case 'B': key = KEY_DOWN;  break;
+        case 'C': key = KEY_RIGHT; break;
+        case 'D': key = KEY_LEFT;  break;
+        default:  key = 0;         break;
+        }
+        consume(3);
+        return key;
+    }
+
+    switch (input[0]) {
+    case 0x1b: key = KEY_ESC;   break;
+    case '\n': key = KEY_ENTER; break;
+    default:   key = input[0];  break;
+    }
+    consume(1);
+    return key;
+}
+
+const char *input_name(void)
+{
+    return null_console ? "none" : "terminal";
+}
+
+void idle(uint32_t ms)
+{
+    struct pollfd pfd = { STDIN_FILENO, POLLIN, 0 };
+    if (!ms || input_len)
+        return;
+    if (null_console)
+        stall(ms * 1000);
+    else
+        poll(&pfd, 1, ms);
+}
+
+/* Memory */
+
+void *allocate(uintn_t size)
+{
+    return malloc(size);
+}
+
+/* Processors */
+
+#define MAX_THREADS (64)
+
+uint32_t processors(void)
+{
+    static uint32_t online = 0;
+    long n;
+
+    if (!online) {
+        n = sysconf(_SC_NPROCESSORS_ONLN);
+        online = n < 1 ? 1 : n > MAX_THREADS ? MAX_THREADS : n;
+    }
+    return online;
+}
+
+struct thread_call {
+    void (*work)(void *arg);
+    void *arg;
+};
+
+static void *thread_start(void *call)
+{
+    ((struct thread_call *) call)->work(((struct thread_call *) call)->arg);
+    return NULL;
+}
+
+/* One thread per other processor, started for each call. The calling thread
+ * does its share too. */
+void parallel(void (*work)(void *arg), void *arg)
+{
+    pthread_t threads[MAX_THREADS];
+    struct thread_call call = { work, arg };
+    uint32_t i, started_threads = 0;
+
+    for (i = 1; i < processors(); i++)
+        if (!pthread_create(&threads[started_threads], NULL, thread_start,
+                            &call))
+            started_threads++;
+    work(arg);
+    for (i = 0; i < started_threads; i++)
+        pthread_join(threads[i], NULL);
+}
+
+/* PC Speaker */
+
+void speaker_on(uint32_t hz)
+{
+}
+
+void speaker_off(void)
+{
+}
+
+/* Console */
+
+struct termios saved_termios;
+bool terminal = false;
+
+/* Escape sequences for the current frame, written out in one go by
+ * console_end(). A frame that repaints every cell with a new attribute needs
+ * about 80 * 25 * 13 bytes. */
+char output[32768];
+size_t output_len = 0;
+/* Attribute the terminal is currently set to, 0xFF if unknown */
+uint8_t output_attr = 0xFF;
+
+static void flush(void)
+{
+    size_t done = 0;
+    ssize_t n;
+    PROFILE_BEGIN(SECTION_FIRMWARE);
+    while (done < output_len) {
+        n = write(STDOUT_FILENO, output + done, output_len - done);
+        if (n <= 0)
+            break;
+        done += n;
+    }
+    PROFILE_END(SECTION_FIRMWARE);
+    output_len = 0;
+    fw_calls++;
+}
+
+static void emit(const char *s)
+{
+    size_t len = strlen(s);
+    if (output_len + len > sizeof(output))
+        flush();
+    memcpy(output + output_len, s, len);
+    output_len += len;
+}
+
+static void restore(void)
+{
+    if (!terminal)
+        return;
+    terminal = false;
+    emit("\033[0m\033[?25h\033[?1049l");
+    flush();
+    tcsetattr(STDIN_FILENO, TCSANOW, &saved_termios);
+}
+
+static void interrupted(int sig)
+{
+    exit(1);
+}
+
+void console_init(void)
+{
+    struct termios raw;
+
+    if (null_console)
+        return;
+    if (tcgetattr(STDIN_FILENO, &saved_termios) == 0) {
+        raw = saved_termios;
+        raw.c_iflag &= ~(ICRNL | IXON);
+        raw.c_lflag &= ~(ICANON | ECHO);
+        raw.c_cc[VMIN] = 0;
+        raw.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+    }
+    terminal = true;
+    atexit(restore);
+    signal(SIGINT, interrupted);
+    signal(SIGTERM, interrupted);
+    /* Switch to the alternate screen, hide the cursor and clear */
+    emit("\033[?1049h\033[?25l\033[2J");
+    output_attr = 0xFF;
+}
+
+void console_fini(void)
+{
+    restore();
+}
+
+/* ANSI color numbers of the EFI colors black to light gray */
+static const char ansi[8] = "04261537";
+
+void console_row(uint8_t y, uint8_t x0, uint8_t x1)
+{
+    char seq[32];
+    uint8_t x, attr;
+
+    if (null_console)
+        return;
+    snprintf(seq, sizeof(seq), "\033[%d;%dH", y + 1, x0 + 1);
+    emit(seq);
+    for (x = x0; x < x1; x++) {
+        attr = screen[y][x].attr;
+        if (attr != output_attr) {
+            snprintf(seq, sizeof(seq), "\033[0;%s3%c;4%cm",
+                     attr & 0x08 ? "1;" : "", ansi[attr & 0x07],
+                     ansi[(attr >> 4) & 0x07]);
+            emit(seq);
+            output_attr = attr;
+        }
+        seq[0] = screen[y][x].c >= ' ' && screen[y][x].c <= '~' ?
+            screen[y][x].c : ' ';
+        seq[1] = 0;
+        emit(seq);
+    }
+}
+
+void console_end(void)
+{
+    if (output_len)
+        flush();
+}
+
+const char *console_name(void)
+{
+    return null_console ? "null" : "terminal";
+}
+
+void print(const char *s)
+{
+    printf("%s\n", s);
+    fflush(stdout);
+}
+
+/* Files */
+
+bool file_save(const char *name, const void *data, uintn_t size)
+{
+    FILE *f = fopen(name, "wb");
+    bool ok;
+    if (!f)
+        return false;
+    ok = fwrite(data, 1, size, f) == size;
+    return !fclose(f) && ok;
+}
+
+bool file_load(const char *name, void *data, uintn_t *size)
+{
+    FILE *f = fopen(name, "rb");
+    bool ok;
+    if (!f)
+        return false;
+    *size = fread(data, 1, *size, f);
+    ok = !ferror(f);
+    fclose(f);
+    return ok;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-bnpP] [-s seed] [-d das] [-a arr] "
+            "[-g gravity]\n"
+            "  -b  run the benchmarks instead of the game\n"
+            "  -n  null console: draw nothing and read no keys\n"
+            "  -p  play back the last game from tetris.rpl\n"
+            "  -P  play it back as fast as possible\n"
+            "  -s  seed for the tetrimino sequence, to replay a game\n"
+            "  -d  delay before a held key moves again, in ms\n"
+            "  -a  delay between moves of a held key, in ms\n"
+            "  -g  gravity in 1/256 rows per step (5120 is 20G), with a lock\n"
+            "      delay, or 0 for the classic rules\n", name);
+    exit(2);
+}
+
+int main(int argc, char *argv[])
+{
+    bool benchmarks = false;
+    int opt;
+    started = ticks();
+    while ((opt = getopt(argc, argv, "bnpPs:d:a:g:")) != -1) {
+        switch (opt) {
+        case 'p':
+            playback = PLAYBACK_REAL_TIME;
+            break;
+        case 'P':
+            playback = PLAYBACK_FAST;
+            break;
+        case 's':
+            seed = strtoul(optarg, NULL, 10);
+            break;
+        case 'd':
+            das = strtoul(optarg, NULL, 10);
+            break;
+        case 'a':
+            arr = strtoul(optarg, NULL, 10);
+            break;
+        case 'g':
+            gravity = strtoul(optarg, NULL, 10);
+            break;
+        case 'b':
+            benchmarks = true;
+            break;
+        case 'n':
+            null_console = true;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+    if (optind != argc)
+        usage(argv[0]);
+    if (benchmarks)
+        bench();
+    else
+        game();
+    return 0;
+}
@@ -0,0 +1,354 @@
+/*
+ *  UEFI Tetris
+ *  Copyright (C) 2013C2014, Curtis McEnroe programble@gmail.com
+ *
+ *  Permission to use, copy, modify, and/or distribute this software
+ *  for any purpose with or without fee is hereby granted, provided 
+ *  that the above copyright notice and this permission notice
+ *  appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ *  WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL
+ *  THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR 
+ *  CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ *  LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ *  NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ *  CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#include <stdio.h>
+
+#include "tetris.h"
+
+/* Generates pieces.c, the tables of tetrimino geometry the engine uses, from
+ * the shapes below, and the Zobrist keys for hashing wells, so the tables are
+ * constant data and nothing is worked out at run time. Run by make whenever
+ * this file changes:
+ *
+ *     ./mkpieces > pieces.c
+ */
+
+/* The seven tetriminos in each rotation. Each tetrimino is represented as an
+ * array of 4 rotations, each represented by a 4x4 array of color values. */
+static const uint8_t TETRIS[7][4][4][4] = {
+    { /* I */
+        {{0,0,0,0},
+         {4,4,4,4},
+         {0,0,0,0},
+         {0,0,0,0}},
+        {{0,4,0,0},
+         {0,4,0,0},
+         {0,4,0,0},
+         {0,4,0,0}},
+        {{0,0,0,0},
+         {4,4,4,4},
+         {0,0,0,0},
+         {0,0,0,0}},
+        {{0,4,0,0},
+         {0,4,0,0},
+         {0,4,0,0},
+         {0,4,0,0}}
+    },
+    { /* J */
+        {{7,0,0,0},
+         {7,7,7,0},
+         {0,0,0,0},
+         {0,0,0,0}},
+        {{0,7,7,0},
+         {0,7,0,0},
+         {0,7,0,0},
+         {0,0,0,0}},
+        {{0,0,0,0},
+         {7,7,7,0},
+         {0,0,7,0},
+         {0,0,0,0}},
+        {{0,7,0,0},
+         {0,7,0,0},
+         {7,7,0,0},
+         {0,0,0,0}}
+    },
+    { /* L */
+        {{0,0,5,0},
+         {5,5,5,0},
+         {0,0,0,0},
+         {0,0,0,0}},
+        {{0,5,0,0},
+         {0,5,0,0},
+         {0,5,5,0},
+         {0,0,0,0}},
+        {{0,0,0,0},
+         {5,5,5,0},
+         {5,0,0,0},
+         {0,0,0,0}},
+        {{5,5,0,0},
+         {0,5,0,0},
+         {0,5,0,0},
+         {0,0,0,0}}
+    },
+    { /* O */
+        {{0,0,0,0},
+         {0,1,1,0},
+         {0,1,1,0},
+         {0,0,0,0}},
+        {{0,0,0,0},
+         {0,1,1,0},
+         {0,1,1,0},
+         {0,0,0,0}},
+        {{0,0,0,0},
+         {0,1,1,0},
+         {0,1,1,0},
+         {0,0,0,0}},
+        {{0,0,0,0},
+         {0,1,1,0},
+         {0,1,1,0},
+         {0,0,0,0}}
+    },
+    { /* S */
+        {{0,0,0,0},
+         {0,2,2,0},
+         {2,2,0,0},
+         {0,0,0,0}},
+        {{0,2,0,0},
+         {0,2,2,0},
+         {0,0,2,0},
+         {0,0,0,0}},
+        {{0,0,0,0},
+         {0,2,2,0},
+         {2,2,0,0},
+         {0,0,0,0}},
+        {{0,2,0,0},
+         {0,2,2,0},
+         {0,0,2,0},
+         {0,0,0,0}}
+    },
+    { /* T */
+        {{0,6,0,0},
+         {6,6,6,0},
+         {0,0,0,0},
+         {0,0,0,0}},
+        {{0,6,0,0},
+         {0,6,6,0},
+         {0,6,0,0},
+         {0,0,0,0}},
+        {{0,0,0,0},
+         {6,6,6,0},
+         {0,6,0,0},
+         {0,0,0,0}},
+        {{0,6,0,0},
+         {6,6,0,0},
+         {0,6,0,0},
+         {0,0,0,0}}
+    },
+    { /* Z */
+        {{0,0,0,0},
+         {3,3,0,0},
+         {0,3,3,0},
+         {0,0,0,0}},
+        {{0,0,3,0},
+         {0,3,3,0},
+         {0,3,0,0},
+         {0,0,0,0}},
+        {{0,0,0,0},
+         {3,3,0,0},
+         {0,3,3,0},
+         {0,0,0,0}},
+        {{0,0,3,0},
+         {0,3,3,0},
+         {0,3,0,0},
+         {0,0,0,0}}
+    }
+};
+
+static const char NAMES[] = "IJLOSTZ";
+
+/* The engine's generator, PCG32 (see rng_next()), seeded as it always was for
+ * the Zobrist keys, so hashes are the same as before they were generated. */
+static uint64_t pcg_state, pcg_inc;
+
+static uint32_t pcg_next(void)
+{
+    uint64_t old = pcg_state;
+    uint32_t x, r;
+    pcg_state = old * 6364136223846793005ULL + pcg_inc;
+    x = ((old >> 18) ^ old) >> 27;
+    r = old >> 59;
+    return (x >> r) | (x << (-r & 31));
+}
+
+static uint64_t pcg_key(void)
+{
+    uint64_t high = pcg_next();
+    return high << 32 | pcg_next();
+}
+
+/* The license header of the generated file, the same as this one's */
+static const char HEADER[] =
+    "/*\n"
+    " *  UEFI Tetris\n"
+    " *  Copyright (C) 2013C2014, Curtis McEnroe programble@gmail.com\n"
+    " *\n"
+    " *  Permission to use, copy, modify, and/or distribute this software\n"
+    " *  for any purpose with or without fee is hereby granted, provided \n"
+    " *  that the above copyright notice and this permission notice\n"
+    " *  appear in all copies.\n"
+    " *\n"
+    " *  THE SOFTWARE IS PROVIDED \"AS IS\" AND THE AUTHOR DISCLAIMS ALL\n"
+    " *  WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED\n"
+    " *  WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL\n"
+    " *  THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR \n"
+    " *  CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM\n"
+    " *  LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,\n"
+    " *  NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN\n"
+    " *  CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.\n"
+    " */\n";
+
+int main(void)
+{
+    int i, r, x, y, n, left, top, right, bottom, mask, low, high, color, half;
+    uint64_t cell[WELL_WIDTH / 2], key;
+
+    printf("%s\n", HEADER);
+    printf("/* Generated by mkpieces from the tetriminos in mkpieces.c. Do not "
+           "edit. */\n\n#include \"tetris.h\"\n");
+
+    printf("\nconst uint8_t TETRIS_COLOR[7] = {");
+    for (i = 0; i < 7; i++) {
+        for (color = 0, y = 0; y < 4; y++)
+            for (x = 0; x < 4; x++)
+                if (TETRIS[i][0][y][x])
+                    color = TETRIS[i][0][y][x];
+        printf(i ? ", %d" : " %d", color);
+    }
+    printf(" };\n");
+
+    printf("\nconst struct offset TETRIS_CELLS[7][4][4] = {\n");
+    for (i = 0; i < 7; i++) {
+        printf("    { /* %c */\n", NAMES[i]);
+        for (r = 0; r < 4; r++) {
+            printf("        {");
+            for (n = 0, y = 0; y < 4; y++)
+                for (x = 0; x < 4; x++)
+                    if (TETRIS[i][r][y][x])
+                        printf(n++ ? ", {%d, %d}" : "{%d, %d}", x, y);
+            if (n != 4) {
+                fprintf(stderr, "mkpieces: %c has %d cells\n", NAMES[i], n);
+                return 1;
+            }
+            printf(r < 3 ? "},\n" : "}\n");
+        }
+        printf(i < 6 ? "    },\n" : "    }\n");
+    }
+    printf("};\n");
+
+    printf("\nconst uint16_t TETRIS_MASK[7][4][4] = {\n");
+    for (i = 0; i < 7; i++) {
+        printf("    { /* %c */\n", NAMES[i]);
+        for (r = 0; r < 4; r++) {
+            printf("        {");
+            for (y = 0; y < 4; y++) {
+                for (mask = 0, x = 0; x < 4; x++)
+                    if (TETRIS[i][r][y][x])
+                        mask |= 1 << x;
+                printf(y ? ", 0x%X" : "0x%X", mask);
+            }
+            printf(r < 3 ? "},\n" : "}\n");
+        }
+        printf(i < 6 ? "    },\n" : "    }\n");
+    }
+    printf("};\n");
+
+    printf("\nconst struct box TETRIS_BOX[7][4] = {\n");
+    for (i = 0; i < 7; i++) {
+        printf("    { /* %c */\n       ", NAMES[i]);
+        for (r = 0; r < 4; r++) {
+            left = top = 3;
+            right = bottom = 0;
+            for (y = 0; y < 4; y++)
+                for (x = 0; x < 4; x++)
+                    if (TETRIS[i][r][y][x]) {
+                        left = x < left ? x : left;
+                        top = y < top ? y : top;
+                        right = x > right ? x : right;
+                        bottom = y > bottom ? y : bottom;
+                    }
+            printf(" {%d, %d, %d, %d}%s", left, top, right, bottom,
+                   r < 3 ? "," : "\n");
+        }
+        printf(i < 6 ? "    },\n" : "    }\n");
+    }
+    printf("};\n");
+
+    /* Columns with no cells get -1 in both */
+    printf("\nconst int8_t TETRIS_TOP[7][4][4] = {\n");
+    for (i = 0; i < 7; i++) {
+        printf("    { /* %c */\n       ", NAMES[i]);
+        for (r = 0; r < 4; r++) {
+            printf(" {");
+            for (x = 0; x < 4; x++) {
+                for (high = -1, y = 3; y >= 0; y--)
+                    if (TETRIS[i][r][y][x])
+                        high = y;
+                printf(x ? ", %d" : "%d", high);
+            }
+            printf(r < 3 ? "}," : "}\n");
+        }
+        printf(i < 6 ? "    },\n" : "    }\n");
+    }
+    printf("};\n");
+
+    printf("\nconst int8_t TETRIS_BOTTOM[7][4][4] = {\n");
+    for (i = 0; i < 7; i++) {
+        printf("    { /* %c */\n       ", NAMES[i]);
+        for (r = 0; r < 4; r++) {
+            printf(" {");
+            for (x = 0; x < 4; x++) {
+                for (low = -1, y = 0; y < 4; y++)
+                    if (TETRIS[i][r][y][x])
+                        low = y;
+                printf(x ? ", %d" : "%d", low);
+            }
+            printf(r < 3 ? "}," : "}\n");
+        }
+        printf(i < 6 ? "    },\n" : "    }\n");
+    }
+    printf("};\n");
+
+    /* Each row of the well has a key per cell, for each half of it the XOR
+     * of the keys of every pattern of its cells, then each tetrimino has a
+     * key, all in the order they are drawn. */
+    pcg_state = 0;
+    pcg_inc = 0xDA3E39CB94B95BDBULL | 1;
+    pcg_next();
+    pcg_state += 0x5A0B;
+    pcg_next();
+    printf("\nconst uint64_t ZOBRIST_ROW[WELL_HEIGHT][2][1 << WELL_WIDTH / 2] "
+           "= {\n");
+    for (y = 0; y < WELL_HEIGHT; y++) {
+        printf("    { /* row %d */\n", y);
+        for (half = 0; half < 2; half++) {
+            for (x = 0; x < WELL_WIDTH / 2; x++)
+                cell[x] = pcg_key();
+            printf("        {");
+            for (n = 0; n < 1 << WELL_WIDTH / 2; n++) {
+                for (key = 0, x = 0; x < WELL_WIDTH / 2; x++)
+                    if (n & 1 << x)
+                        key ^= cell[x];
+                printf("%s0x%016llX", !n ? "\n            " :
+                       n % 3 ? ", " : ",\n            ",
+                       (unsigned long long) key);
+            }
+            printf(half ? "\n        }\n" : "\n        },\n");
+        }
+        printf(y < WELL_HEIGHT - 1 ? "    },\n" : "    }\n");
+    }
+    printf("};\n");
+
+    printf("\nconst uint64_t ZOBRIST_PIECE[7] = {\n");
+    for (i = 0; i < 7; i++)
+        printf("    0x%016llX%s /* %c */\n", (unsigned long long) pcg_key(),
+               i < 6 ? "," : " ", NAMES[i]);
+    printf("};\n");
+    return 0;
+}
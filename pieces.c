@@ -0,0 +1,815 @@
+/*
+ *  UEFI Tetris
+ *  Copyright (C) 2013C2014, Curtis McEnroe programble@gmail.com
+ *
+ *  Permission to use, copy, modify, and/or distribute this software
+ *  for any purpose with or without fee is hereby granted, provided 
+ *  that the above copyright notice and this permission notice
+ *  appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ *  WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL
+ *  THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR 
+ *  CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ *  LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ *  NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ *  CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* Generated by mkpieces from the tetriminos in mkpieces.c. Do not edit. */
+
+#include "tetris.h"
+
+const uint8_t TETRIS_COLOR[7] = { 4, 7, 5, 1, 2, 6, 3 };
+
+const struct offset TETRIS_CELLS[7][4][4] = {
+    { /* I */
+        {{0, 1}, {1, 1}, {2, 1}, {3, 1}},
+        {{1, 0}, {1, 1}, {1, 2}, {1, 3}},
+        {{0, 1}, {1, 1}, {2, 1}, {3, 1}},
+        {{1, 0}, {1, 1}, {1, 2}, {1, 3}}
+    },
+    { /* J */
+        {{0, 0}, {0, 1}, {1, 1}, {2, 1}},
+        {{1, 0}, {2, 0}, {1, 1}, {1, 2}},
+        {{0, 1}, {1, 1}, {2, 1}, {2, 2}},
+        {{1, 0}, {1, 1}, {0, 2}, {1, 2}}
+    },
+    { /* L */
+        {{2, 0}, {0, 1}, {1, 1}, {2, 1}},
+        {{1, 0}, {1, 1}, {1, 2}, {2, 2}},
+        {{0, 1}, {1, 1}, {2, 1}, {0, 2}},
+        {{0, 0}, {1, 0}, {1, 1}, {1, 2}}
+    },
+    { /* O */
+        {{1, 1}, {2, 1}, {1, 2}, {2, 2}},
+        {{1, 1}, {2, 1}, {1, 2}, {2, 2}},
+        {{1, 1}, {2, 1}, {1, 2}, {2, 2}},
+        {{1, 1}, {2, 1}, {1, 2}, {2, 2}}
+    },
+    { /* S */
+        {{1, 1}, {2, 1}, {0, 2}, {1, 2}},
+        {{1, 0}, {1, 1}, {2, 1}, {2, 2}},
+        {{1, 1}, {2, 1}, {0, 2}, {1, 2}},
+        {{1, 0}, {1, 1}, {2, 1}, {2, 2}}
+    },
+    { /* T */
+        {{1, 0}, {0, 1}, {1, 1}, {2, 1}},
+        {{1, 0}, {1, 1}, {2, 1}, {1, 2}},
+        {{0, 1}, {1, 1}, {2, 1}, {1, 2}},
+        {{1, 0}, {0, 1}, {1, 1}, {1, 2}}
+    },
+    { /* Z */
+        {{0, 1}, {1, 1}, {1, 2}, {2, 2}},
+        {{2, 0}, {1, 1}, {2, 1}, {1, 2}},
+        {{0, 1}, {1, 1}, {1, 2}, {2, 2}},
+        {{2, 0}, {1, 1}, {2, 1}, {1, 2}}
+    }
+};
+
+const uint16_t TETRIS_MASK[7][4][4] = {
+    { /* I */
+        {0x0, 0xF, 0x0, 0x0},
+        {0x2, 0x2, 0x2, 0x2},
+        {0x0, 0xF, 0x0, 0x0},
+        {0x2, 0x2, 0x2, 0x2}
+    },
+    { /* J */
+        {0x1, 0x7, 0x0, 0x0},
+        {0x6, 0x2, 0x2, 0x0},
+        {0x0, 0x7, 0x4, 0x0},
+        {0x2, 0x2, 0x3, 0x0}
+    },
+    { /* L */
+        {0x4, 0x7, 0x0, 0x0},
+        {0x2, 0x2, 0x6, 0x0},
+        {0x0, 0x7, 0x1, 0x0},
+        {0x3, 0x2, 0x2, 0x0}
+    },
+    { /* O */
+        {0x0, 0x6, 0x6, 0x0},
+        {0x0, 0x6, 0x6, 0x0},
+        {0x0, 0x6, 0x6, 0x0},
+        {0x0, 0x6, 0x6, 0x0}
+    },
+    { /* S */
+        {0x0, 0x6, 0x3, 0x0},
+        {0x2, 0x6, 0x4, 0x0},
+        {0x0, 0x6, 0x3, 0x0},
+        {0x2, 0x6, 0x4, 0x0}
+    },
+    { /* T */
+        {0x2, 0x7, 0x0, 0x0},
+        {0x2, 0x6, 0x2, 0x0},
+        {0x0, 0x7, 0x2, 0x0},
+        {0x2, 0x3, 0x2, 0x0}
+    },
+    { /* Z */
+        {0x0, 0x3, 0x6, 0x0},
+        {0x4, 0x6, 0x2, 0x0},
+        {0x0, 0x3, 0x6, 0x0},
+        {0x4, 0x6, 0x2, 0x0}
+    }
+};
+
+const struct box TETRIS_BOX[7][4] = {
+    { /* I */
+        {0, 1, 3, 1}, {1, 0, 1, 3}, {0, 1, 3, 1}, {1, 0, 1, 3}
+    },
+    { /* J */
+        {0, 0, 2, 1}, {1, 0, 2, 2}, {0, 1, 2, 2}, {0, 0, 1, 2}
+    },
+    { /* L */
+        {0, 0, 2, 1}, {1, 0, 2, 2}, {0, 1, 2, 2}, {0, 0, 1, 2}
+    },
+    { /* O */
+        {1, 1, 2, 2}, {1, 1, 2, 2}, {1, 1, 2, 2}, {1, 1, 2, 2}
+    },
+    { /* S */
+        {0, 1, 2, 2}, {1, 0, 2, 2}, {0, 1, 2, 2}, {1, 0, 2, 2}
+    },
+    { /* T */
+        {0, 0, 2, 1}, {1, 0, 2, 2}, {0, 1, 2, 2}, {0, 0, 1, 2}
+    },
+    { /* Z */
+        {0, 1, 2, 2}, {1, 0, 2, 2}, {0, 1, 2, 2}, {1, 0, 2, 2}
+    }
+};
+
+const int8_t TETRIS_TOP[7][4][4] = {
+    { /* I */
+        {1, 1, 1, 1}, {-1, 0, -1, -1}, {1, 1, 1, 1}, {-1, 0, -1, -1}
+    },
+    { /* J */
+        {0, 1, 1, -1}, {-1, 0, 0, -1}, {1, 1, 1, -1}, {2, 0, -1, -1}
+    },
+    { /* L */
+        {1, 1, 0, -1}, {-1, 0, 2, -1}, {1, 1, 1, -1}, {0, 0, -1, -1}
+    },
+    { /* O */
+        {-1, 1, 1, -1}, {-1, 1, 1, -1}, {-1, 1, 1, -1}, {-1, 1, 1, -1}
+    },
+    { /* S */
+        {2, 1, 1, -1}, {-1, 0, 1, -1}, {2, 1, 1, -1}, {-1, 0, 1, -1}
+    },
+    { /* T */
+        {1, 0, 1, -1}, {-1, 0, 1, -1}, {1, 1, 1, -1}, {1, 0, -1, -1}
+    },
+    { /* Z */
+        {1, 1, 2, -1}, {-1, 1, 0, -1}, {1, 1, 2, -1}, {-1, 1, 0, -1}
+    }
+};
+
+const int8_t TETRIS_BOTTOM[7][4][4] = {
+    { /* I */
+        {1, 1, 1, 1}, {-1, 3, -1, -1}, {1, 1, 1, 1}, {-1, 3, -1, -1}
+    },
+    { /* J */
+        {1, 1, 1, -1}, {-1, 2, 0, -1}, {1, 1, 2, -1}, {2, 2, -1, -1}
+    },
+    { /* L */
+        {1, 1, 1, -1}, {-1, 2, 2, -1}, {2, 1, 1, -1}, {0, 2, -1, -1}
+    },
+    { /* O */
+        {-1, 2, 2, -1}, {-1, 2, 2, -1}, {-1, 2, 2, -1}, {-1, 2, 2, -1}
+    },
+    { /* S */
+        {2, 2, 1, -1}, {-1, 1, 2, -1}, {2, 2, 1, -1}, {-1, 1, 2, -1}
+    },
+    { /* T */
+        {1, 1, 1, -1}, {-1, 2, 1, -1}, {1, 2, 1, -1}, {1, 2, -1, -1}
+    },
+    { /* Z */
+        {1, 2, 2, -1}, {-1, 2, 1, -1}, {1, 2, 2, -1}, {-1, 2, 1, -1}
+    }
+};
+
+const uint64_t ZOBRIST_ROW[WELL_HEIGHT][2][1 << WELL_WIDTH / 2] = {
+    { /* row 0 */
+        {
+            0x0000000000000000, 0x497FB0557FCF9332, 0xACD6BD6DC260CB85,
+            0xE5A90D38BDAF58B7, 0xA1E8553C19CC903C, 0xE897E5696603030E,
+            0x0D3EE851DBAC5BB9, 0x44415804A463C88B, 0x601DB97F43EECFDB,
+            0x2962092A3C215CE9, 0xCCCB0412818E045E, 0x85B4B447FE41976C,
+            0xC1F5EC435A225FE7, 0x888A5C1625EDCCD5, 0x6D23512E98429462,
+            0x245CE17BE78D0750, 0x9310FA8FE76C18EA, 0xDA6F4ADA98A38BD8,
+            0x3FC647E2250CD36F, 0x76B9F7B75AC3405D, 0x32F8AFB3FEA088D6,
+            0x7B871FE6816F1BE4, 0x9E2E12DE3CC04353, 0xD751A28B430FD061,
+            0xF30D43F0A482D731, 0xBA72F3A5DB4D4403, 0x5FDBFE9D66E21CB4,
+            0x16A44EC8192D8F86, 0x52E516CCBD4E470D, 0x1B9AA699C281D43F,
+            0xFE33ABA17F2E8C88, 0xB74C1BF400E11FBA
+        },
+        {
+            0x0000000000000000, 0x3808308E06D02A9F, 0x0A5AEE0A5D16A603,
+            0x3252DE845BC68C9C, 0xD25856FACD1AB89A, 0xEA506674CBCA9205,
+            0xD802B8F0900C1E99, 0xE00A887E96DC3406, 0x21AE5F7E086A02A0,
+            0x19A66FF00EBA283F, 0x2BF4B174557CA4A3, 0x13FC81FA53AC8E3C,
+            0xF3F60984C570BA3A, 0xCBFE390AC3A090A5, 0xF9ACE78E98661C39,
+            0xC1A4D7009EB636A6, 0x754A507B74B387EA, 0x4D4260F57263AD75,
+            0x7F10BE7129A521E9, 0x47188EFF2F750B76, 0xA7120681B9A93F70,
+            0x9F1A360FBF7915EF, 0xAD48E88BE4BF9973, 0x9540D805E26FB3EC,
+            0x54E40F057CD9854A, 0x6CEC3F8B7A09AFD5, 0x5EBEE10F21CF2349,
+            0x66B6D181271F09D6, 0x86BC59FFB1C33DD0, 0xBEB46971B713174F,
+            0x8CE6B7F5ECD59BD3, 0xB4EE877BEA05B14C
+        }
+    },
+    { /* row 1 */
+        {
+            0x0000000000000000, 0x3A63C3EB57CE5882, 0x637A76D7A9AC41CD,
+            0x5919B53CFE62194F, 0xE847BE92411EC4BA, 0xD2247D7916D09C38,
+            0x8B3DC845E8B28577, 0xB15E0BAEBF7CDDF5, 0x27E0C3F2E20D51CE,
+            0x1D830019B5C3094C, 0x449AB5254BA11003, 0x7EF976CE1C6F4881,
+            0xCFA77D60A3139574, 0xF5C4BE8BF4DDCDF6, 0xACDD0BB70ABFD4B9,
+            0x96BEC85C5D718C3B, 0xAB0114F1FA4FC918, 0x9162D71AAD81919A,
+            0xC87B622653E388D5, 0xF218A1CD042DD057, 0x4346AA63BB510DA2,
+            0x79256988EC9F5520, 0x203CDCB412FD4C6F, 0x1A5F1F5F453314ED,
+            0x8CE1D703184298D6, 0xB68214E84F8CC054, 0xEF9BA1D4B1EED91B,
+            0xD5F8623FE6208199, 0x64A66991595C5C6C, 0x5EC5AA7A0E9204EE,
+            0x07DC1F46F0F01DA1, 0x3DBFDCADA73E4523
+        },
+        {
+            0x0000000000000000, 0x6771A6C98285AB14, 0xAEC6CCEAA3489942,
+            0xC9B76A2321CD3256, 0x3FA226527A5C4478, 0x58D3809BF8D9EF6C,
+            0x9164EAB8D914DD3A, 0xF6154C715B91762E, 0x6927F57DDED0B0A7,
+            0x0E5653B45C551BB3, 0xC7E139977D9829E5, 0xA0909F5EFF1D82F1,
+            0x5685D32FA48CF4DF, 0x31F475E626095FCB, 0xF8431FC507C46D9D,
+            0x9F32B90C8541C689, 0x627208CB8CC2C096, 0x0503AE020E476B82,
+            0xCCB4C4212F8A59D4, 0xABC562E8AD0FF2C0, 0x5DD02E99F69E84EE,
+            0x3AA18850741B2FFA, 0xF316E27355D61DAC, 0x946744BAD753B6B8,
+            0x0B55FDB652127031, 0x6C245B7FD097DB25, 0xA593315CF15AE973,
+            0xC2E2979573DF4267, 0x34F7DBE4284E3449, 0x53867D2DAACB9F5D,
+            0x9A31170E8B06AD0B, 0xFD40B1C70983061F
+        }
+    },
+    { /* row 2 */
+        {
+            0x0000000000000000, 0xF28FB4C516A38BDC, 0xF95CBFF8877E2FAE,
+            0x0BD30B3D91DDA472, 0x1A4524F863820603, 0xE8CA903D75218DDF,
+            0xE3199B00E4FC29AD, 0x11962FC5F25FA271, 0x4132A8889C1976A5,
+            0xB3BD1C4D8ABAFD79, 0xB86E17701B67590B, 0x4AE1A3B50DC4D2D7,
+            0x5B778C70FF9B70A6, 0xA9F838B5E938FB7A, 0xA22B338878E55F08,
+            0x50A4874D6E46D4D4, 0x7821E6848493D72B, 0x8AAE524192305CF7,
+            0x817D597C03EDF885, 0x73F2EDB9154E7359, 0x6264C27CE711D128,
+            0x90EB76B9F1B25AF4, 0x9B387D84606FFE86, 0x69B7C94176CC755A,
+            0x39134E0C188AA18E, 0xCB9CFAC90E292A52, 0xC04FF1F49FF48E20,
+            0x32C04531895705FC, 0x23566AF47B08A78D, 0xD1D9DE316DAB2C51,
+            0xDA0AD50CFC768823, 0x288561C9EAD503FF
+        },
+        {
+            0x0000000000000000, 0x101CADF2AE42EAA7, 0x7247DAABBC56A218,
+            0x625B7759121448BF, 0x0FEBCD4573ED53DE, 0x1FF760B7DDAFB979,
+            0x7DAC17EECFBBF1C6, 0x6DB0BA1C61F91B61, 0x40D339E1486BF34F,
+            0x50CF9413E62919E8, 0x3294E34AF43D5157, 0x22884EB85A7FBBF0,
+            0x4F38F4A43B86A091, 0x5F24595695C44A36, 0x3D7F2E0F87D00289,
+            0x2D6383FD2992E82E, 0x16DE4FB4D50B3BC1, 0x06C2E2467B49D166,
+            0x6499951F695D99D9, 0x748538EDC71F737E, 0x193582F1A6E6681F,
+            0x09292F0308A482B8, 0x6B72585A1AB0CA07, 0x7B6EF5A8B4F220A0,
+            0x560D76559D60C88E, 0x4611DBA733222229, 0x244AACFE21366A96,
+            0x3456010C8F748031, 0x59E6BB10EE8D9B50, 0x49FA16E240CF71F7,
+            0x2BA161BB52DB3948, 0x3BBDCC49FC99D3EF
+        }
+    },
+    { /* row 3 */
+        {
+            0x0000000000000000, 0xF48EC026812D9CA8, 0x9F26775C99ECB5D6,
+            0x6BA8B77A18C1297E, 0xB15102211AA4E0DE, 0x45DFC2079B897C76,
+            0x2E77757D83485508, 0xDAF9B55B0265C9A0, 0xBF1101288AC53CC4,
+            0x4B9FC10E0BE8A06C, 0x2037767413298912, 0xD4B9B652920415BA,
+            0x0E4003099061DC1A, 0xFACEC32F114C40B2, 0x91667455098D69CC,
+            0x65E8B47388A0F564, 0x82D3AA393EFC5299, 0x765D6A1FBFD1CE31,
+            0x1DF5DD65A710E74F, 0xE97B1D43263D7BE7, 0x3382A8182458B247,
+            0xC70C683EA5752EEF, 0xACA4DF44BDB40791, 0x582A1F623C999B39,
+            0x3DC2AB11B4396E5D, 0xC94C6B373514F2F5, 0xA2E4DC4D2DD5DB8B,
+            0x566A1C6BACF84723, 0x8C93A930AE9D8E83, 0x781D69162FB0122B,
+            0x13B5DE6C37713B55, 0xE73B1E4AB65CA7FD
+        },
+        {
+            0x0000000000000000, 0xCA16DB8366684FF1, 0x5E68B0D6F8355362,
+            0x947E6B559E5D1C93, 0x5D80DDBB232F99F9, 0x979606384547D608,
+            0x03E86D6DDB1ACA9B, 0xC9FEB6EEBD72856A, 0xD53EB17548D14B7B,
+            0x1F286AF62EB9048A, 0x8B5601A3B0E41819, 0x4140DA20D68C57E8,
+            0x88BE6CCE6BFED282, 0x42A8B74D0D969D73, 0xD6D6DC1893CB81E0,
+            0x1CC0079BF5A3CE11, 0xAF67A8F9B104F97A, 0x6571737AD76CB68B,
+            0xF10F182F4931AA18, 0x3B19C3AC2F59E5E9, 0xF2E77542922B6083,
+            0x38F1AEC1F4432F72, 0xAC8FC5946A1E33E1, 0x66991E170C767C10,
+            0x7A59198CF9D5B201, 0xB04FC20F9FBDFDF0, 0x2431A95A01E0E163,
+            0xEE2772D96788AE92, 0x27D9C437DAFA2BF8, 0xEDCF1FB4BC926409,
+            0x79B174E122CF789A, 0xB3A7AF6244A7376B
+        }
+    },
+    { /* row 4 */
+        {
+            0x0000000000000000, 0x498819CB7E8FEFA9, 0x23A7B7F126394EE8,
+            0x6A2FAE3A58B6A141, 0x1336C61EFD559C0F, 0x5ABEDFD583DA73A6,
+            0x309171EFDB6CD2E7, 0x79196824A5E33D4E, 0x0D0188A84691A357,
+            0x44899163381E4CFE, 0x2EA63F5960A8EDBF, 0x672E26921E270216,
+            0x1E374EB6BBC43F58, 0x57BF577DC54BD0F1, 0x3D90F9479DFD71B0,
+            0x7418E08CE3729E19, 0x88EED01C71621C69, 0xC166C9D70FEDF3C0,
+            0xAB4967ED575B5281, 0xE2C17E2629D4BD28, 0x9BD816028C378066,
+            0xD2500FC9F2B86FCF, 0xB87FA1F3AA0ECE8E, 0xF1F7B838D4812127,
+            0x85EF58B437F3BF3E, 0xCC67417F497C5097, 0xA648EF4511CAF1D6,
+            0xEFC0F68E6F451E7F, 0x96D99EAACAA62331, 0xDF518761B429CC98,
+            0xB57E295BEC9F6DD9, 0xFCF6309092108270
+        },
+        {
+            0x0000000000000000, 0x3A5886CD08E27609, 0xAD756A39885FCF82,
+            0x972DECF480BDB98B, 0x46FBB4485914E7C8, 0x7CA3328551F691C1,
+            0xEB8EDE71D14B284A, 0xD1D658BCD9A95E43, 0xAC86865CD78AA3E2,
+            0x96DE0091DF68D5EB, 0x01F3EC655FD56C60, 0x3BAB6AA857371A69,
+            0xEA7D32148E9E442A, 0xD025B4D9867C3223, 0x4708582D06C18BA8,
+            0x7D50DEE00E23FDA1, 0x39F80FDA55F28158, 0x03A089175D10F751,
+            0x948D65E3DDAD4EDA, 0xAED5E32ED54F38D3, 0x7F03BB920CE66690,
+            0x455B3D5F04041099, 0xD276D1AB84B9A912, 0xE82E57668C5BDF1B,
+            0x957E8986827822BA, 0xAF260F4B8A9A54B3, 0x380BE3BF0A27ED38,
+            0x0253657202C59B31, 0xD3853DCEDB6CC572, 0xE9DDBB03D38EB37B,
+            0x7EF057F753330AF0, 0x44A8D13A5BD17CF9
+        }
+    },
+    { /* row 5 */
+        {
+            0x0000000000000000, 0xC1AE11AE3D106491, 0x321DAC2BBE7C1556,
+            0xF3B3BD85836C71C7, 0xCA8028B25DDA89CC, 0x0B2E391C60CAED5D,
+            0xF89D8499E3A69C9A, 0x39339537DEB6F80B, 0x3996DD24C7E0C78C,
+            0xF838CC8AFAF0A31D, 0x0B8B710F799CD2DA, 0xCA2560A1448CB64B,
+            0xF316F5969A3A4E40, 0x32B8E438A72A2AD1, 0xC10B59BD24465B16,
+            0x00A5481319563F87, 0xC0DD2C83CE235CA5, 0x01733D2DF3333834,
+            0xF2C080A8705F49F3, 0x336E91064D4F2D62, 0x0A5D043193F9D569,
+            0xCBF3159FAEE9B1F8, 0x3840A81A2D85C03F, 0xF9EEB9B41095A4AE,
+            0xF94BF1A709C39B29, 0x38E5E00934D3FFB8, 0xCB565D8CB7BF8E7F,
+            0x0AF84C228AAFEAEE, 0x33CBD915541912E5, 0xF265C8BB69097674,
+            0x01D6753EEA6507B3, 0xC0786490D7756322
+        },
+        {
+            0x0000000000000000, 0xEA0D3BE781BC336E, 0x290D104BF1A3E7FB,
+            0xC3002BAC701FD495, 0x207176717FA0B365, 0xCA7C4D96FE1C800B,
+            0x097C663A8E03549E, 0xE3715DDD0FBF67F0, 0x241E14EC191CC413,
+            0xCE132F0B98A0F77D, 0x0D1304A7E8BF23E8, 0xE71E3F4069031086,
+            0x046F629D66BC7776, 0xEE62597AE7004418, 0x2D6272D6971F908D,
+            0xC76F493116A3A3E3, 0x4DB30E4962D95384, 0xA7BE35AEE36560EA,
+            0x64BE1E02937AB47F, 0x8EB325E512C68711, 0x6DC278381D79E0E1,
+            0x87CF43DF9CC5D38F, 0x44CF6873ECDA071A, 0xAEC253946D663474,
+            0x69AD1AA57BC59797, 0x83A02142FA79A4F9, 0x40A00AEE8A66706C,
+            0xAAAD31090BDA4302, 0x49DC6CD4046524F2, 0xA3D1573385D9179C,
+            0x60D17C9FF5C6C309, 0x8ADC4778747AF067
+        }
+    },
+    { /* row 6 */
+        {
+            0x0000000000000000, 0x38E968114CB46CBF, 0x250C8258F5516A8F,
+            0x1DE5EA49B9E50630, 0x9685D94038124F2B, 0xAE6CB15174A62394,
+            0xB3895B18CD4325A4, 0x8B60330981F7491B, 0xAEC5B2036D6087F5,
+            0x962CDA1221D4EB4A, 0x8BC9305B9831ED7A, 0xB320584AD48581C5,
+            0x38406B435572C8DE, 0x00A9035219C6A461, 0x1D4CE91BA023A251,
+            0x25A5810AEC97CEEE, 0x9594F51E5620F936, 0xAD7D9D0F1A949589,
+            0xB0987746A37193B9, 0x88711F57EFC5FF06, 0x03112C5E6E32B61D,
+            0x3BF8444F2286DAA2, 0x261DAE069B63DC92, 0x1EF4C617D7D7B02D,
+            0x3B51471D3B407EC3, 0x03B82F0C77F4127C, 0x1E5DC545CE11144C,
+            0x26B4AD5482A578F3, 0xADD49E5D035231E8, 0x953DF64C4FE65D57,
+            0x88D81C05F6035B67, 0xB0317414BAB737D8
+        },
+        {
+            0x0000000000000000, 0xA2B4B64AF04739FF, 0x2E9236EC2B49A88F,
+            0x8C2680A6DB0E9170, 0xEAF654FC42FBDDE7, 0x4842E2B6B2BCE418,
+            0xC464621069B27568, 0x66D0D45A99F54C97, 0x8A99EC518B50A39E,
+            0x282D5A1B7B179A61, 0xA40BDABDA0190B11, 0x06BF6CF7505E32EE,
+            0x606FB8ADC9AB7E79, 0xC2DB0EE739EC4786, 0x4EFD8E41E2E2D6F6,
+            0xEC49380B12A5EF09, 0x26F8936E9425A00F, 0x844C2524646299F0,
+            0x086AA582BF6C0880, 0xAADE13C84F2B317F, 0xCC0EC792D6DE7DE8,
+            0x6EBA71D826994417, 0xE29CF17EFD97D567, 0x402847340DD0EC98,
+            0xAC617F3F1F750391, 0x0ED5C975EF323A6E, 0x82F349D3343CAB1E,
+            0x2047FF99C47B92E1, 0x46972BC35D8EDE76, 0xE4239D89ADC9E789,
+            0x68051D2F76C776F9, 0xCAB1AB6586804F06
+        }
+    },
+    { /* row 7 */
+        {
+            0x0000000000000000, 0xE9700F24C0D41BF2, 0x426E2B2BD5796575,
+            0xAB1E240F15AD7E87, 0x5BE86157AA1D06E5, 0xB2986E736AC91D17,
+            0x19864A7C7F646390, 0xF0F64558BFB07862, 0x2BEA965149821DE2,
+            0xC29A997589560610, 0x6984BD7A9CFB7897, 0x80F4B25E5C2F6365,
+            0x7002F706E39F1B07, 0x9972F822234B00F5, 0x326CDC2D36E67E72,
+            0xDB1CD309F6326580, 0xCC3DEFCFE26FC6E8, 0x254DE0EB22BBDD1A,
+            0x8E53C4E43716A39D, 0x6723CBC0F7C2B86F, 0x97D58E984872C00D,
+            0x7EA581BC88A6DBFF, 0xD5BBA5B39D0BA578, 0x3CCBAA975DDFBE8A,
+            0xE7D7799EABEDDB0A, 0x0EA776BA6B39C0F8, 0xA5B952B57E94BE7F,
+            0x4CC95D91BE40A58D, 0xBC3F18C901F0DDEF, 0x554F17EDC124C61D,
+            0xFE5133E2D489B89A, 0x17213CC6145DA368
+        },
+        {
+            0x0000000000000000, 0x16517AF0EB54F5C1, 0x6D0FD5AC0C0ED5D3,
+            0x7B5EAF5CE75A2012, 0x8122A594A3FEACB8, 0x9773DF6448AA5979,
+            0xEC2D7038AFF0796B, 0xFA7C0AC844A48CAA, 0x78EBA1620D92203A,
+            0x6EBADB92E6C6D5FB, 0x15E474CE019CF5E9, 0x03B50E3EEAC80028,
+            0xF9C904F6AE6C8C82, 0xEF987E0645387943, 0x94C6D15AA2625951,
+            0x8297ABAA4936AC90, 0xC0F40A4A962FD1A8, 0xD6A570BA7D7B2469,
+            0xADFBDFE69A21047B, 0xBBAAA5167175F1BA, 0x41D6AFDE35D17D10,
+            0x5787D52EDE8588D1, 0x2CD97A7239DFA8C3, 0x3A880082D28B5D02,
+            0xB81FAB289BBDF192, 0xAE4ED1D870E90453, 0xD5107E8497B32441,
+            0xC34104747CE7D180, 0x393D0EBC38435D2A, 0x2F6C744CD317A8EB,
+            0x5432DB10344D88F9, 0x4263A1E0DF197D38
+        }
+    },
+    { /* row 8 */
+        {
+            0x0000000000000000, 0x8A46B0271E087E8A, 0x03159E16BAC26AEF,
+            0x89532E31A4CA1465, 0x9B95C9F4D5D21ECB, 0x11D379D3CBDA6041,
+            0x988057E26F107424, 0x12C6E7C571180AAE, 0xA8AFBAF14798DE57,
+            0x22E90AD65990A0DD, 0xABBA24E7FD5AB4B8, 0x21FC94C0E352CA32,
+            0x333A7305924AC09C, 0xB97CC3228C42BE16, 0x302FED132888AA73,
+            0xBA695D343680D4F9, 0xF64EB182AB80B743, 0x7C0801A5B588C9C9,
+            0xF55B2F941142DDAC, 0x7F1D9FB30F4AA326, 0x6DDB78767E52A988,
+            0xE79DC851605AD702, 0x6ECEE660C490C367, 0xE4885647DA98BDED,
+            0x5EE10B73EC186914, 0xD4A7BB54F210179E, 0x5DF4956556DA03FB,
+            0xD7B2254248D27D71, 0xC574C28739CA77DF, 0x4F3272A027C20955,
+            0xC6615C9183081D30, 0x4C27ECB69D0063BA
+        },
+        {
+            0x0000000000000000, 0x117272901D1DE8A6, 0xA3165AF32D29B199,
+            0xB26428633034593F, 0xD05BF91E62C79BE0, 0xC1298B8E7FDA7346,
+            0x734DA3ED4FEE2A79, 0x623FD17D52F3C2DF, 0x57EC8CF730F197F0,
+            0x469EFE672DEC7F56, 0xF4FAD6041DD82669, 0xE588A49400C5CECF,
+            0x87B775E952360C10, 0x96C507794F2BE4B6, 0x24A12F1A7F1FBD89,
+            0x35D35D8A6202552F, 0x275B299C8CE1A925, 0x36295B0C91FC4183,
+            0x844D736FA1C818BC, 0x953F01FFBCD5F01A, 0xF700D082EE2632C5,
+            0xE672A212F33BDA63, 0x54168A71C30F835C, 0x4564F8E1DE126BFA,
+            0x70B7A56BBC103ED5, 0x61C5D7FBA10DD673, 0xD3A1FF9891398F4C,
+            0xC2D38D088C2467EA, 0xA0EC5C75DED7A535, 0xB19E2EE5C3CA4D93,
+            0x03FA0686F3FE14AC, 0x12887416EEE3FC0A
+        }
+    },
+    { /* row 9 */
+        {
+            0x0000000000000000, 0xB6239041940C47E2, 0x0887C9660FB05C55,
+            0xBEA459279BBC1BB7, 0xE719CB6CBCA25C46, 0x513A5B2D28AE1BA4,
+            0xEF9E020AB3120013, 0x59BD924B271E47F1, 0xBD21AB94A0DED4E3,
+            0x0B023BD534D29301, 0xB5A662F2AF6E88B6, 0x0385F2B33B62CF54,
+            0x5A3860F81C7C88A5, 0xEC1BF0B98870CF47, 0x52BFA99E13CCD4F0,
+            0xE49C39DF87C09312, 0x37FB64383A163828, 0x81D8F479AE1A7FCA,
+            0x3F7CAD5E35A6647D, 0x895F3D1FA1AA239F, 0xD0E2AF5486B4646E,
+            0x66C13F1512B8238C, 0xD86566328904383B, 0x6E46F6731D087FD9,
+            0x8ADACFAC9AC8ECCB, 0x3CF95FED0EC4AB29, 0x825D06CA9578B09E,
+            0x347E968B0174F77C, 0x6DC304C0266AB08D, 0xDBE09481B266F76F,
+            0x6544CDA629DAECD8, 0xD3675DE7BDD6AB3A
+        },
+        {
+            0x0000000000000000, 0x2788C6B2D9F47454, 0x8830DEF02AC1A1F6,
+            0xAFB81842F335D5A2, 0xDC3D9E8C368F26F9, 0xFBB5583EEF7B52AD,
+            0x540D407C1C4E870F, 0x738586CEC5BAF35B, 0xA785A180A6778479,
+            0x800D67327F83F02D, 0x2FB57F708CB6258F, 0x083DB9C2554251DB,
+            0x7BB83F0C90F8A280, 0x5C30F9BE490CD6D4, 0xF388E1FCBA390376,
+            0xD400274E63CD7722, 0x755CB72AAF07B93A, 0x52D4719876F3CD6E,
+            0xFD6C69DA85C618CC, 0xDAE4AF685C326C98, 0xA96129A699889FC3,
+            0x8EE9EF14407CEB97, 0x2151F756B3493E35, 0x06D931E46ABD4A61,
+            0xD2D916AA09703D43, 0xF551D018D0844917, 0x5AE9C85A23B19CB5,
+            0x7D610EE8FA45E8E1, 0x0EE488263FFF1BBA, 0x296C4E94E60B6FEE,
+            0x86D456D6153EBA4C, 0xA15C9064CCCACE18
+        }
+    },
+    { /* row 10 */
+        {
+            0x0000000000000000, 0xEB08ACBA404E779B, 0xAFC6A4A02B50F839,
+            0x44CE081A6B1E8FA2, 0x4CECF86FD5BE3980, 0xA7E454D595F04E1B,
+            0xE32A5CCFFEEEC1B9, 0x0822F075BEA0B622, 0x242BB36A2F3A7BAA,
+            0xCF231FD06F740C31, 0x8BED17CA046A8393, 0x60E5BB704424F408,
+            0x68C74B05FA84422A, 0x83CFE7BFBACA35B1, 0xC701EFA5D1D4BA13,
+            0x2C09431F919ACD88, 0x9B20BAA6B8ACD2DD, 0x7028161CF8E2A546,
+            0x34E61E0693FC2AE4, 0xDFEEB2BCD3B25D7F, 0xD7CC42C96D12EB5D,
+            0x3CC4EE732D5C9CC6, 0x780AE66946421364, 0x93024AD3060C64FF,
+            0xBF0B09CC9796A977, 0x5403A576D7D8DEEC, 0x10CDAD6CBCC6514E,
+            0xFBC501D6FC8826D5, 0xF3E7F1A3422890F7, 0x18EF5D190266E76C,
+            0x5C215503697868CE, 0xB729F9B929361F55
+        },
+        {
+            0x0000000000000000, 0x695DFC0DB14B2200, 0x0BD586D2361580D3,
+            0x62887ADF875EA2D3, 0xCA761D08C24D7A9E, 0xA32BE1057306589E,
+            0xC1A39BDAF458FA4D, 0xA8FE67D74513D84D, 0x24246A6FACB3972D,
+            0x4D7996621DF8B52D, 0x2FF1ECBD9AA617FE, 0x46AC10B02BED35FE,
+            0xEE5277676EFEEDB3, 0x870F8B6ADFB5CFB3, 0xE587F1B558EB6D60,
+            0x8CDA0DB8E9A04F60, 0xDD76F8BD8FF0A025, 0xB42B04B03EBB8225,
+            0xD6A37E6FB9E520F6, 0xBFFE826208AE02F6, 0x1700E5B54DBDDABB,
+            0x7E5D19B8FCF6F8BB, 0x1CD563677BA85A68, 0x75889F6ACAE37868,
+            0xF95292D223433708, 0x900F6EDF92081508, 0xF28714001556B7DB,
+            0x9BDAE80DA41D95DB, 0x33248FDAE10E4D96, 0x5A7973D750456F96,
+            0x38F10908D71BCD45, 0x51ACF5056650EF45
+        }
+    },
+    { /* row 11 */
+        {
+            0x0000000000000000, 0xA18E083F7B12B988, 0x7F854FCF400BF4CF,
+            0xDE0B47F03B194D47, 0xD287361323391F86, 0x73093E2C582BA60E,
+            0xAD0279DC6332EB49, 0x0C8C71E3182052C1, 0xD53DE55AC08BF273,
+            0x74B3ED65BB994BFB, 0xAAB8AA95808006BC, 0x0B36A2AAFB92BF34,
+            0x07BAD349E3B2EDF5, 0xA634DB7698A0547D, 0x783F9C86A3B9193A,
+            0xD9B194B9D8ABA0B2, 0x199ABA8FD6CA1C69, 0xB814B2B0ADD8A5E1,
+            0x661FF54096C1E8A6, 0xC791FD7FEDD3512E, 0xCB1D8C9CF5F303EF,
+            0x6A9384A38EE1BA67, 0xB498C353B5F8F720, 0x1516CB6CCEEA4EA8,
+            0xCCA75FD51641EE1A, 0x6D2957EA6D535792, 0xB322101A564A1AD5,
+            0x12AC18252D58A35D, 0x1E2069C63578F19C, 0xBFAE61F94E6A4814,
+            0x61A5260975730553, 0xC02B2E360E61BCDB
+        },
+        {
+            0x0000000000000000, 0xE2CAF20FB35CD442, 0x3BEC2574BE18C096,
+            0xD926D77B0D4414D4, 0x72AA851330B84E92, 0x9060771C83E49AD0,
+            0x4946A0678EA08E04, 0xAB8C52683DFC5A46, 0x13C9CE9BB5C26A82,
+            0xF1033C94069EBEC0, 0x2825EBEF0BDAAA14, 0xCAEF19E0B8867E56,
+            0x61634B88857A2410, 0x83A9B9873626F052, 0x5A8F6EFC3B62E486,
+            0xB8459CF3883E30C4, 0x121809A82BCE0A1E, 0xF0D2FBA79892DE5C,
+            0x29F42CDC95D6CA88, 0xCB3EDED3268A1ECA, 0x60B28CBB1B76448C,
+            0x82787EB4A82A90CE, 0x5B5EA9CFA56E841A, 0xB9945BC016325058,
+            0x01D1C7339E0C609C, 0xE31B353C2D50B4DE, 0x3A3DE2472014A00A,
+            0xD8F7104893487448, 0x737B4220AEB42E0E, 0x91B1B02F1DE8FA4C,
+            0x4897675410ACEE98, 0xAA5D955BA3F03ADA
+        }
+    },
+    { /* row 12 */
+        {
+            0x0000000000000000, 0x7E98908601A18D01, 0x24D66B6DA4D45ADE,
+            0x5A4EFBEBA575D7DF, 0xAD6D13CAD204084B, 0xD3F5834CD3A5854A,
+            0x89BB78A776D05295, 0xF723E8217771DF94, 0xDBCA39B580902C97,
+            0xA552A9338131A196, 0xFF1C52D824447649, 0x8184C25E25E5FB48,
+            0x76A72A7F529424DC, 0x083FBAF95335A9DD, 0x52714112F6407E02,
+            0x2CE9D194F7E1F303, 0x9FAD6FB1A6B1248E, 0xE135FF37A710A98F,
+            0xBB7B04DC02657E50, 0xC5E3945A03C4F351, 0x32C07C7B74B52CC5,
+            0x4C58ECFD7514A1C4, 0x16161716D061761B, 0x688E8790D1C0FB1A,
+            0x4467560426210819, 0x3AFFC68227808518, 0x60B13D6982F552C7,
+            0x1E29ADEF8354DFC6, 0xE90A45CEF4250052, 0x9792D548F5848D53,
+            0xCDDC2EA350F15A8C, 0xB344BE255150D78D
+        },
+        {
+            0x0000000000000000, 0x62A2CBB2CCDB06B6, 0x82F7162788A817C5,
+            0xE055DD9544731173, 0xBDB035540F4B038D, 0xDF12FEE6C390053B,
+            0x3F47237387E31448, 0x5DE5E8C14B3812FE, 0x122D4D96D2B88253,
+            0x708F86241E6384E5, 0x90DA5BB15A109596, 0xF278900396CB9320,
+            0xAF9D78C2DDF381DE, 0xCD3FB37011288768, 0x2D6A6EE5555B961B,
+            0x4FC8A557998090AD, 0x8C36CDCDEFD1B0AB, 0xEE94067F230AB61D,
+            0x0EC1DBEA6779A76E, 0x6C631058ABA2A1D8, 0x3186F899E09AB326,
+            0x5324332B2C41B590, 0xB371EEBE6832A4E3, 0xD1D3250CA4E9A255,
+            0x9E1B805B3D6932F8, 0xFCB94BE9F1B2344E, 0x1CEC967CB5C1253D,
+            0x7E4E5DCE791A238B, 0x23ABB50F32223175, 0x41097EBDFEF937C3,
+            0xA15CA328BA8A26B0, 0xC3FE689A76512006
+        }
+    },
+    { /* row 13 */
+        {
+            0x0000000000000000, 0x88A5C507B086E32F, 0xD6E8F5BF2EE069AD,
+            0x5E4D30B89E668A82, 0x2BA34C36045ABD99, 0xA3068931B4DC5EB6,
+            0xFD4BB9892ABAD434, 0x75EE7C8E9A3C371B, 0xEB6EAB22D6F53817,
+            0x63CB6E256673DB38, 0x3D865E9DF81551BA, 0xB5239B9A4893B295,
+            0xC0CDE714D2AF858E, 0x48682213622966A1, 0x162512ABFC4FEC23,
+            0x9E80D7AC4CC90F0C, 0x26F84AFC4B921B42, 0xAE5D8FFBFB14F86D,
+            0xF010BF43657272EF, 0x78B57A44D5F491C0, 0x0D5B06CA4FC8A6DB,
+            0x85FEC3CDFF4E45F4, 0xDBB3F3756128CF76, 0x53163672D1AE2C59,
+            0xCD96E1DE9D672355, 0x453324D92DE1C07A, 0x1B7E1461B3874AF8,
+            0x93DBD1660301A9D7, 0xE635ADE8993D9ECC, 0x6E9068EF29BB7DE3,
+            0x30DD5857B7DDF761, 0xB8789D50075B144E
+        },
+        {
+            0x0000000000000000, 0x0B35412E898ADC38, 0x76B0364FA3D28F22,
+            0x7D8577612A58531A, 0x500F6327184E3809, 0x5B3A220991C4E431,
+            0x26BF5568BB9CB72B, 0x2D8A144632166B13, 0x51B972A7BB9AC04D,
+            0x5A8C338932101C75, 0x270944E818484F6F, 0x2C3C05C691C29357,
+            0x01B61180A3D4F844, 0x0A8350AE2A5E247C, 0x770627CF00067766,
+            0x7C3366E1898CAB5E, 0xD211E9DD7DC38D3A, 0xD924A8F3F4495102,
+            0xA4A1DF92DE110218, 0xAF949EBC579BDE20, 0x821E8AFA658DB533,
+            0x892BCBD4EC07690B, 0xF4AEBCB5C65F3A11, 0xFF9BFD9B4FD5E629,
+            0x83A89B7AC6594D77, 0x889DDA544FD3914F, 0xF518AD35658BC255,
+            0xFE2DEC1BEC011E6D, 0xD3A7F85DDE17757E, 0xD892B973579DA946,
+            0xA517CE127DC5FA5C, 0xAE228F3CF44F2664
+        }
+    },
+    { /* row 14 */
+        {
+            0x0000000000000000, 0x1BCE86F487DA42C0, 0xD764D832BAC3499D,
+            0xCCAA5EC63D190B5D, 0x3CEA56B5B66E7530, 0x2724D04131B437F0,
+            0xEB8E8E870CAD3CAD, 0xF04008738B777E6D, 0xEA5984E764C5D13F,
+            0xF1970213E31F93FF, 0x3D3D5CD5DE0698A2, 0x26F3DA2159DCDA62,
+            0xD6B3D252D2ABA40F, 0xCD7D54A65571E6CF, 0x01D70A606868ED92,
+            0x1A198C94EFB2AF52, 0xF35E662C13FB6386, 0xE890E0D894212146,
+            0x243ABE1EA9382A1B, 0x3FF438EA2EE268DB, 0xCFB43099A59516B6,
+            0xD47AB66D224F5476, 0x18D0E8AB1F565F2B, 0x031E6E5F988C1DEB,
+            0x1907E2CB773EB2B9, 0x02C9643FF0E4F079, 0xCE633AF9CDFDFB24,
+            0xD5ADBC0D4A27B9E4, 0x25EDB47EC150C789, 0x3E23328A468A8549,
+            0xF2896C4C7B938E14, 0xE947EAB8FC49CCD4
+        },
+        {
+            0x0000000000000000, 0x910C90F21954227C, 0x4581E52D8FD04A16,
+            0xD48D75DF9684686A, 0x73AA6D582EB47042, 0xE2A6FDAA37E0523E,
+            0x362B8875A1643A54, 0xA7271887B8301828, 0xE2BC8BB49BA7C19E,
+            0x73B01B4682F3E3E2, 0xA73D6E9914778B88, 0x3631FE6B0D23A9F4,
+            0x9116E6ECB513B1DC, 0x001A761EAC4793A0, 0xD49703C13AC3FBCA,
+            0x459B93332397D9B6, 0x788ABC5FE3D3E1A3, 0xE9862CADFA87C3DF,
+            0x3D0B59726C03ABB5, 0xAC07C980755789C9, 0x0B20D107CD6791E1,
+            0x9A2C41F5D433B39D, 0x4EA1342A42B7DBF7, 0xDFADA4D85BE3F98B,
+            0x9A3637EB7874203D, 0x0B3AA71961200241, 0xDFB7D2C6F7A46A2B,
+            0x4EBB4234EEF04857, 0xE99C5AB356C0507F, 0x7890CA414F947203,
+            0xAC1DBF9ED9101A69, 0x3D112F6CC0443815
+        }
+    },
+    { /* row 15 */
+        {
+            0x0000000000000000, 0x354145B35B89E5F6, 0x92FEBFD8330A1306,
+            0xA7BFFA6B6883F6F0, 0x15A81DA57B84888D, 0x20E95816200D6D7B,
+            0x8756A27D488E9B8B, 0xB217E7CE13077E7D, 0x37A1783B27BD6EE7,
+            0x02E03D887C348B11, 0xA55FC7E314B77DE1, 0x901E82504F3E9817,
+            0x2209659E5C39E66A, 0x1748202D07B0039C, 0xB0F7DA466F33F56C,
+            0x85B69FF534BA109A, 0x8C7A4B758C42A687, 0xB93B0EC6D7CB4371,
+            0x1E84F4ADBF48B581, 0x2BC5B11EE4C15077, 0x99D256D0F7C62E0A,
+            0xAC931363AC4FCBFC, 0x0B2CE908C4CC3D0C, 0x3E6DACBB9F45D8FA,
+            0xBBDB334EABFFC860, 0x8E9A76FDF0762D96, 0x29258C9698F5DB66,
+            0x1C64C925C37C3E90, 0xAE732EEBD07B40ED, 0x9B326B588BF2A51B,
+            0x3C8D9133E37153EB, 0x09CCD480B8F8B61D
+        },
+        {
+            0x0000000000000000, 0xB4260516B19BE122, 0x4EC017CD14F30B86,
+            0xFAE612DBA568EAA4, 0x66421A5CE44770E7, 0xD2641F4A55DC91C5,
+            0x28820D91F0B47B61, 0x9CA40887412F9A43, 0xB41B8835E188BE45,
+            0x003D8D2350135F67, 0xFADB9FF8F57BB5C3, 0x4EFD9AEE44E054E1,
+            0xD259926905CFCEA2, 0x667F977FB4542F80, 0x9C9985A4113CC524,
+            0x28BF80B2A0A72406, 0x58506AE7BADF2AAA, 0xEC766FF10B44CB88,
+            0x16907D2AAE2C212C, 0xA2B6783C1FB7C00E, 0x3E1270BB5E985A4D,
+            0x8A3475ADEF03BB6F, 0x70D267764A6B51CB, 0xC4F46260FBF0B0E9,
+            0xEC4BE2D25B5794EF, 0x586DE7C4EACC75CD, 0xA28BF51F4FA49F69,
+            0x16ADF009FE3F7E4B, 0x8A09F88EBF10E408, 0x3E2FFD980E8B052A,
+            0xC4C9EF43ABE3EF8E, 0x70EFEA551A780EAC
+        }
+    },
+    { /* row 16 */
+        {
+            0x0000000000000000, 0x99164B2548FA0DA8, 0x1C15785BA82877C6,
+            0x8503337EE0D27A6E, 0xD46B264026477F0B, 0x4D7D6D656EBD72A3,
+            0xC87E5E1B8E6F08CD, 0x5168153EC6950565, 0x70B838417935C80D,
+            0xE9AE736431CFC5A5, 0x6CAD401AD11DBFCB, 0xF5BB0B3F99E7B263,
+            0xA4D31E015F72B706, 0x3DC555241788BAAE, 0xB8C6665AF75AC0C0,
+            0x21D02D7FBFA0CD68, 0x0317B5B2E72A4C38, 0x9A01FE97AFD04190,
+            0x1F02CDE94F023BFE, 0x861486CC07F83656, 0xD77C93F2C16D3333,
+            0x4E6AD8D789973E9B, 0xCB69EBA9694544F5, 0x527FA08C21BF495D,
+            0x73AF8DF39E1F8435, 0xEAB9C6D6D6E5899D, 0x6FBAF5A83637F3F3,
+            0xF6ACBE8D7ECDFE5B, 0xA7C4ABB3B858FB3E, 0x3ED2E096F0A2F696,
+            0xBBD1D3E810708CF8, 0x22C798CD588A8150
+        },
+        {
+            0x0000000000000000, 0xCF789F75E6F2242A, 0x904F5EBAFFABCCE0,
+            0x5F37C1CF1959E8CA, 0xF0D555E61BD221B0, 0x3FADCA93FD20059A,
+            0x609A0B5CE479ED50, 0xAFE29429028BC97A, 0x6B47C9027AA5A7BA,
+            0xA43F56779C578390, 0xFB0897B8850E6B5A, 0x347008CD63FC4F70,
+            0x9B929CE46177860A, 0x54EA03918785A220, 0x0BDDC25E9EDC4AEA,
+            0xC4A55D2B782E6EC0, 0xE4D003064ADA0546, 0x2BA89C73AC28216C,
+            0x749F5DBCB571C9A6, 0xBBE7C2C95383ED8C, 0x140556E0510824F6,
+            0xDB7DC995B7FA00DC, 0x844A085AAEA3E816, 0x4B32972F4851CC3C,
+            0x8F97CA04307FA2FC, 0x40EF5571D68D86D6, 0x1FD894BECFD46E1C,
+            0xD0A00BCB29264A36, 0x7F429FE22BAD834C, 0xB03A0097CD5FA766,
+            0xEF0DC158D4064FAC, 0x20755E2D32F46B86
+        }
+    },
+    { /* row 17 */
+        {
+            0x0000000000000000, 0xF2A492D896B0C810, 0x504EAF35476A3D12,
+            0xA2EA3DEDD1DAF502, 0x45171386F01012F1, 0xB7B3815E66A0DAE1,
+            0x1559BCB3B77A2FE3, 0xE7FD2E6B21CAE7F3, 0xD0ADA95E19D23CBE,
+            0x22093B868F62F4AE, 0x80E3066B5EB801AC, 0x724794B3C808C9BC,
+            0x95BABAD8E9C22E4F, 0x671E28007F72E65F, 0xC5F415EDAEA8135D,
+            0x375087353818DB4D, 0xD3A83E7EFDEFB064, 0x210CACA66B5F7874,
+            0x83E6914BBA858D76, 0x714203932C354566, 0x96BF2DF80DFFA295,
+            0x641BBF209B4F6A85, 0xC6F182CD4A959F87, 0x34551015DC255797,
+            0x03059720E43D8CDA, 0xF1A105F8728D44CA, 0x534B3815A357B1C8,
+            0xA1EFAACD35E779D8, 0x461284A6142D9E2B, 0xB4B6167E829D563B,
+            0x165C2B935347A339, 0xE4F8B94BC5F76B29
+        },
+        {
+            0x0000000000000000, 0xC85328E8BF63DD38, 0xF99C507B4CFDBBEE,
+            0x31CF7893F39E66D6, 0x567959B041EC2142, 0x9E2A7158FE8FFC7A,
+            0xAFE509CB0D119AAC, 0x67B62123B2724794, 0x16B5B171D014CC52,
+            0xDEE699996F77116A, 0xEF29E10A9CE977BC, 0x277AC9E2238AAA84,
+            0x40CCE8C191F8ED10, 0x889FC0292E9B3028, 0xB950B8BADD0556FE,
+            0x7103905262668BC6, 0x52689AA1EE2AD6E1, 0x9A3BB24951490BD9,
+            0xABF4CADAA2D76D0F, 0x63A7E2321DB4B037, 0x0411C311AFC6F7A3,
+            0xCC42EBF910A52A9B, 0xFD8D936AE33B4C4D, 0x35DEBB825C589175,
+            0x44DD2BD03E3E1AB3, 0x8C8E0338815DC78B, 0xBD417BAB72C3A15D,
+            0x75125343CDA07C65, 0x12A472607FD23BF1, 0xDAF75A88C0B1E6C9,
+            0xEB38221B332F801F, 0x236B0AF38C4C5D27
+        }
+    },
+    { /* row 18 */
+        {
+            0x0000000000000000, 0x3276F5F0B7C34D26, 0xE4137D30F950CEB6,
+            0xD66588C04E938390, 0xD49F8C753864F6BE, 0xE6E979858FA7BB98,
+            0x308CF145C1343808, 0x02FA04B576F7752E, 0x7739F9D1D2FC3FF6,
+            0x454F0C21653F72D0, 0x932A84E12BACF140, 0xA15C71119C6FBC66,
+            0xA3A675A4EA98C948, 0x91D080545D5B846E, 0x47B5089413C807FE,
+            0x75C3FD64A40B4AD8, 0x521E44F84CD23A54, 0x6068B108FB117772,
+            0xB60D39C8B582F4E2, 0x847BCC380241B9C4, 0x8681C88D74B6CCEA,
+            0xB4F73D7DC37581CC, 0x6292B5BD8DE6025C, 0x50E4404D3A254F7A,
+            0x2527BD299E2E05A2, 0x175148D929ED4884, 0xC134C019677ECB14,
+            0xF34235E9D0BD8632, 0xF1B8315CA64AF31C, 0xC3CEC4AC1189BE3A,
+            0x15AB4C6C5F1A3DAA, 0x27DDB99CE8D9708C
+        },
+        {
+            0x0000000000000000, 0xC33DB2DA5818EA3E, 0x7652705200E44E7F,
+            0xB56FC28858FCA441, 0xB597390CC733FADB, 0x76AA8BD69F2B10E5,
+            0xC3C5495EC7D7B4A4, 0x00F8FB849FCF5E9A, 0xCE90DC0242C56700,
+            0x0DAD6ED81ADD8D3E, 0xB8C2AC504221297F, 0x7BFF1E8A1A39C341,
+            0x7B07E50E85F69DDB, 0xB83A57D4DDEE77E5, 0x0D55955C8512D3A4,
+            0xCE682786DD0A399A, 0x4C77D4BDDAE2FE2A, 0x8F4A666782FA1414,
+            0x3A25A4EFDA06B055, 0xF9181635821E5A6B, 0xF9E0EDB11DD104F1,
+            0x3ADD5F6B45C9EECF, 0x8FB29DE31D354A8E, 0x4C8F2F39452DA0B0,
+            0x82E708BF9827992A, 0x41DABA65C03F7314, 0xF4B578ED98C3D755,
+            0x3788CA37C0DB3D6B, 0x377031B35F1463F1, 0xF44D8369070C89CF,
+            0x412241E15FF02D8E, 0x821FF33B07E8C7B0
+        }
+    },
+    { /* row 19 */
+        {
+            0x0000000000000000, 0x9A0182F2AD6C45C2, 0x5C31113CB6CF4F14,
+            0xC63093CE1BA30AD6, 0x4FFA8A17D21497D5, 0xD5FB08E57F78D217,
+            0x13CB9B2B64DBD8C1, 0x89CA19D9C9B79D03, 0xF1931CFD7A649F6A,
+            0x6B929E0FD708DAA8, 0xADA20DC1CCABD07E, 0x37A38F3361C795BC,
+            0xBE6996EAA87008BF, 0x24681418051C4D7D, 0xE25887D61EBF47AB,
+            0x78590524B3D30269, 0x89784ECC861CD9AF, 0x1379CC3E2B709C6D,
+            0xD5495FF030D396BB, 0x4F48DD029DBFD379, 0xC682C4DB54084E7A,
+            0x5C834629F9640BB8, 0x9AB3D5E7E2C7016E, 0x00B257154FAB44AC,
+            0x78EB5231FC7846C5, 0xE2EAD0C351140307, 0x24DA430D4AB709D1,
+            0xBEDBC1FFE7DB4C13, 0x3711D8262E6CD110, 0xAD105AD4830094D2,
+            0x6B20C91A98A39E04, 0xF1214BE835CFDBC6
+        },
+        {
+            0x0000000000000000, 0x86DDE07925B30B27, 0xE7F35B4C7D564434,
+            0x612EBB3558E54F13, 0x6F0A36497FB415DF, 0xE9D7D6305A071EF8,
+            0x88F96D0502E251EB, 0x0E248D7C27515ACC, 0x4A42D425BBDDC7F6,
+            0xCC9F345C9E6ECCD1, 0xADB18F69C68B83C2, 0x2B6C6F10E33888E5,
+            0x2548E26CC469D229, 0xA3950215E1DAD90E, 0xC2BBB920B93F961D,
+            0x446659599C8C9D3A, 0xC33C34FAE2F26FFE, 0x45E1D483C74164D9,
+            0x24CF6FB69FA42BCA, 0xA2128FCFBA1720ED, 0xAC3602B39D467A21,
+            0x2AEBE2CAB8F57106, 0x4BC559FFE0103E15, 0xCD18B986C5A33532,
+            0x897EE0DF592FA808, 0x0FA300A67C9CA32F, 0x6E8DBB932479EC3C,
+            0xE8505BEA01CAE71B, 0xE674D696269BBDD7, 0x60A936EF0328B6F0,
+            0x01878DDA5BCDF9E3, 0x875A6DA37E7EF2C4
+        }
+    },
+    { /* row 20 */
+        {
+            0x0000000000000000, 0xCA8210E0AF195455, 0x48D9C667A179C434,
+            0x825BD6870E609061, 0x0D4B1E99CDBB8405, 0xC7C90E7962A2D050,
+            0x4592D8FE6CC24031, 0x8F10C81EC3DB1464, 0x07A23CFE3B0686B2,
+            0xCD202C1E941FD2E7, 0x4F7BFA999A7F4286, 0x85F9EA79356616D3,
+            0x0AE92267F6BD02B7, 0xC06B328759A456E2, 0x4230E40057C4C683,
+            0x88B2F4E0F8DD92D6, 0xF93A24E753ABD876, 0x33B83407FCB28C23,
+            0xB1E3E280F2D21C42, 0x7B61F2605DCB4817, 0xF4713A7E9E105C73,
+            0x3EF32A9E31090826, 0xBCA8FC193F699847, 0x762AECF99070CC12,
+            0xFE98181968AD5EC4, 0x341A08F9C7B40A91, 0xB641DE7EC9D49AF0,
+            0x7CC3CE9E66CDCEA5, 0xF3D30680A516DAC1, 0x395116600A0F8E94,
+            0xBB0AC0E7046F1EF5, 0x7188D007AB764AA0
+        },
+        {
+            0x0000000000000000, 0x5C7C05B435E4AD45, 0x01BC536A8FBEA922,
+            0x5DC056DEBA5A0467, 0xDCED36376D762AE9, 0x80913383589287AC,
+            0xDD51655DE2C883CB, 0x812D60E9D72C2E8E, 0x723165969C7B7E97,
+            0x2E4D6022A99FD3D2, 0x738D36FC13C5D7B5, 0x2FF1334826217AF0,
+            0xAEDC53A1F10D547E, 0xF2A05615C4E9F93B, 0xAF6000CB7EB3FD5C,
+            0xF31C057F4B575019, 0xFD22E8F05DEDFE0C, 0xA15EED4468095349,
+            0xFC9EBB9AD253572E, 0xA0E2BE2EE7B7FA6B, 0x21CFDEC7309BD4E5,
+            0x7DB3DB73057F79A0, 0x20738DADBF257DC7, 0x7C0F88198AC1D082,
+            0x8F138D66C196809B, 0xD36F88D2F4722DDE, 0x8EAFDE0C4E2829B9,
+            0xD2D3DBB87BCC84FC, 0x53FEBB51ACE0AA72, 0x0F82BEE599040737,
+            0x5242E83B235E0350, 0x0E3EED8F16BAAE15
+        }
+    },
+    { /* row 21 */
+        {
+            0x0000000000000000, 0x3AB0AE4CE5F7EE73, 0x67ECCB271102E17F,
+            0x5D5C656BF4F50F0C, 0x077962B7FF8063D7, 0x3DC9CCFB1A778DA4,
+            0x6095A990EE8282A8, 0x5A2507DC0B756CDB, 0xC70D0CEE4367AD66,
+            0xFDBDA2A2A6904315, 0xA0E1C7C952654C19, 0x9A516985B792A26A,
+            0xC0746E59BCE7CEB1, 0xFAC4C015591020C2, 0xA798A57EADE52FCE,
+            0x9D280B324812C1BD, 0xF80A563673B361C8, 0xC2BAF87A96448FBB,
+            0x9FE69D1162B180B7, 0xA556335D87466EC4, 0xFF7334818C33021F,
+            0xC5C39ACD69C4EC6C, 0x989FFFA69D31E360, 0xA22F51EA78C60D13,
+            0x3F075AD830D4CCAE, 0x05B7F494D52322DD, 0x58EB91FF21D62DD1,
+            0x625B3FB3C421C3A2, 0x387E386FCF54AF79, 0x02CE96232AA3410A,
+            0x5F92F348DE564E06, 0x65225D043BA1A075
+        },
+        {
+            0x0000000000000000, 0x06E88D620FD45085, 0x7A0551304F9EC3B7,
+            0x7CEDDC52404A9332, 0xE2F1C9C56C11CE32, 0xE41944A763C59EB7,
+            0x98F498F5238F0D85, 0x9E1C15972C5B5D00, 0x4FE4FBB246443886,
+            0x490C76D049906803, 0x35E1AA8209DAFB31, 0x330927E0060EABB4,
+            0xAD1532772A55F6B4, 0xABFDBF152581A631, 0xD710634765CB3503,
+            0xD1F8EE256A1F6586, 0x35779D1B4E0682F8, 0x339F107941D2D27D,
+            0x4F72CC2B0198414F, 0x499A41490E4C11CA, 0xD78654DE22174CCA,
+            0xD16ED9BC2DC31C4F, 0xAD8305EE6D898F7D, 0xAB6B888C625DDFF8,
+            0x7A9366A90842BA7E, 0x7C7BEBCB0796EAFB, 0x0096379947DC79C9,
+            0x067EBAFB4808294C, 0x9862AF6C6453744C, 0x9E8A220E6B8724C9,
+            0xE267FE5C2BCDB7FB, 0xE48F733E2419E77E
+        }
+    }
+};
+
+const uint64_t ZOBRIST_PIECE[7] = {
+    0x62F2C00D3BD24DB2, /* I */
+    0xCB5F8422494CCBF3, /* J */
+    0x41268BC2FAFA225F, /* L */
+    0xC9165690C26981BC, /* O */
+    0xA8A57B88E21CAD85, /* S */
+    0xC1F5A0D7315F38D0, /* T */
+    0x8578DDDFBDD2690E  /* Z */
+};
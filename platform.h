@@ -0,0 +1,293 @@
+/*
+ *  UEFI Tetris
+ *  Copyright (C) 2013C2014, Curtis McEnroe programble@gmail.com
+ *
+ *  Permission to use, copy, modify, and/or distribute this software
+ *  for any purpose with or without fee is hereby granted, provided 
+ *  that the above copyright notice and this permission notice
+ *  appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ *  WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL
+ *  THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR 
+ *  CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ *  LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ *  NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ *  CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+/* Everything the game needs from the environment it runs in: a clock,
+ * keyboard input, a console and a speaker. efi.c implements it on top of UEFI
+ * boot services, host.c on top of a POSIX terminal (built with -DHOST). */
+
+#ifdef HOST
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef size_t uintn_t;
+
+#else
+
+#include <efi.h>
+#include <efilib.h>
+
+typedef UINT8 uint8_t;
+typedef UINT16 uint16_t;
+typedef UINT32 uint32_t;
+typedef UINT64 uint64_t;
+typedef UINTN uintn_t;
+typedef INT8 int8_t;
+typedef INT16 int16_t;
+typedef INT32 int32_t;
+typedef INT64 int64_t;
+typedef CHAR16 char16_t;
+typedef UINTN size_t;
+
+static inline void *memcpy (void *dest, const void *src, size_t len)
+{
+    void *edi = dest;
+    const void *esi = src;
+    int discard_ecx;
+
+    asm volatile ("rep movsl" : "=&D" (edi), "=&S" (esi), "=&c" (discard_ecx) : "0" (edi), "1" (esi), "2" (len >> 2) : "memory");
+    asm volatile ("rep movsb" : "=&D" (edi), "=&S" (esi), "=&c" (discard_ecx) : "0" (edi), "1" (esi), "2" (len & 3) : "memory");
+    return dest;
+}
+
+static inline void *memset (void *dest, int c, size_t len)
+{
+    void *edi = dest;
+    int eax = c;
+    int discard_ecx;
+
+    eax |= ( eax << 8 );
+    eax |= ( eax << 16 );
+
+    asm volatile ("rep stosl" : "=&D" (edi), "=&a" (eax), "=&c" (discard_ecx) : "0" (edi), "1" (eax), "2" (len >> 2) : "memory");
+    asm volatile ("rep stosb" : "=&D" (edi), "=&a" (eax), "=&c" (discard_ecx) : "0" (edi), "1" (eax), "2" (len & 3) : "memory" );
+    return dest;
+}
+
+static inline int memcmp (const void *a, const void *b, size_t len)
+{
+    const uint8_t *p = a, *q = b;
+    for (; len; len--, p++, q++)
+        if (*p != *q)
+            return *p - *q;
+    return 0;
+}
+
+#endif
+
+typedef enum bool {
+    false,
+    true
+} bool;
+
+/* Run the game until the player exits. Implemented in game.c and called by
+ * the platform's entry point. */
+void game(void);
+
+/* Delayed auto-shift and auto-repeat rate for moving sideways, in
+ * milliseconds. Defined in game.c; the platform may change them from its
+ * command line before calling game(). */
+extern uint32_t das, arr;
+
+/* Seed for the sequence of tetriminos, or 0 to take one from the clock.
+ * Defined in game.c; the platform may set it to replay a game. */
+extern uint32_t seed;
+
+/* Gravity in 1/256 rows per gravity step, as on arcade machines: 256 is one
+ * row per step, and 5120 (20G) or more drops each tetrimino to where it lands
+ * as soon as it spawns. Tetriminos then lock after a lock delay. 0 keeps the
+ * classic rules. Defined in game.c; the platform may set it from its command
+ * line. */
+extern uint32_t gravity;
+
+/* Whether game() plays back the replay of the last game instead of a new
+ * one, and if so in real time or as fast as it can. Defined in game.c. */
+enum playback {
+    PLAYBACK_OFF,
+    PLAYBACK_REAL_TIME,
+    PLAYBACK_FAST
+};
+extern enum playback playback;
+
+/* Run the benchmarks and print their results. Implemented in bench.c and
+ * called by the platform's entry point instead of game() when asked to. */
+void bench(void);
+
+/* Print a line of text outside of the game screen, on the firmware console or
+ * standard output. */
+void print(const char *s);
+
+/* Timing */
+
+/* The number of clock ticks per millisecond */
+extern uint64_t tpms;
+
+/* Return the number of clock ticks since an arbitrary point in the past. */
+uint64_t ticks(void);
+
+/* Set tpms. Returns quickly: at worst it measures the clock for a few
+ * milliseconds. */
+void calibrate(void);
+
+/* How calibrate() obtained tpms */
+extern const char *calibration;
+
+/* The value of ticks() when the program was started, for measuring how long
+ * it takes to get to the game */
+extern uint64_t started;
+
+/* Return the current second field of the real-time-clock (RTC), in whatever
+ * encoding the clock uses (usually BCD). */
+uint8_t rtcs(void);
+
+/* Wait at least us microseconds. */
+void stall(uintn_t us);
+
+/* Keyboard Input */
+
+#define KEY_A     'a'
+#define KEY_D     'd'
+#define KEY_H     'h'
+#define KEY_P     'p'
+#define KEY_R     'r'
+#define KEY_S     's'
+/* EFI scan codes, other platforms translate to these */
+#define KEY_UP    0x01
+#define KEY_DOWN  0x02
+#define KEY_RIGHT 0x03
+#define KEY_LEFT  0x04
+#define KEY_ESC   0x17
+#define KEY_ENTER 0x0d
+#define KEY_SPACE ' '
+
+/* Return the next pending key, or 0 if there is none. Calling it until it
+ * returns 0 drains every key that is pending. */
+int scan(void);
+
+/* Return a short name for the way keys are read, for display */
+const char *input_name(void);
+
+/* Sleep until a key is pending or ms milliseconds have passed, whichever is
+ * first. Returns immediately if a key is already pending. */
+void idle(uint32_t ms);
+
+/* Console */
+
+#define COLS (80)
+#define ROWS (25)
+
+/* A character cell. attr uses the EFI text attribute encoding: foreground
+ * color in the low nibble, background color in bits 4-6. */
+struct cell {
+    uint8_t c;
+    uint8_t attr;
+};
+
+/* The cells to show, and the cells as last output by the console. */
+extern struct cell screen[ROWS][COLS];
+extern struct cell shown[ROWS][COLS];
+
+/* Number of calls into the firmware (or system calls) the console made while
+ * outputting the current frame. */
+extern uint32_t fw_calls;
+
+/* Return true if the cell at x, y differs from what the console shows. */
+static inline bool changed(uint8_t x, uint8_t y)
+{
+    return screen[y][x].c != shown[y][x].c ||
+        screen[y][x].attr != shown[y][x].attr;
+}
+
+/* Set up the console for the game and pick a backend. */
+void console_init(void);
+
+/* Restore the console to the state console_init() found it in. */
+void console_fini(void);
+
+/* Output the changed cells of row y of screen from x0 up to but not including
+ * x1. Cells in that range that did not change may be output too. */
+void console_row(uint8_t y, uint8_t x0, uint8_t x1);
+
+/* Finish outputting a frame. */
+void console_end(void);
+
+/* Return the name of the console backend in use. */
+const char *console_name(void);
+
+/* Files, in the root directory of the volume tetris.efi was loaded from, or
+ * the working directory */
+
+/* Write size bytes of data to the file name, replacing it. Return true if it
+ * was all written. */
+bool file_save(const char *name, const void *data, uintn_t size);
+
+/* Read up to *size bytes of the file name into data and set *size to the
+ * number of bytes read. Return false if the file could not be read. */
+bool file_load(const char *name, void *data, uintn_t *size);
+
+/* Memory */
+
+/* Return size bytes of memory that stay allocated until the program exits,
+ * or NULL if there is not that much. For tables allocated once at start. */
+void *allocate(uintn_t size);
+
+/* Processors */
+
+/* Return the number of processors parallel() runs work on, the calling one
+ * included. */
+uint32_t processors(void);
+
+/* Call work(arg) on each of the processors at once, and return when every
+ * call has returned. work runs on processors the firmware knows nothing
+ * about, so it must only compute: no platform calls, no allocation. */
+void parallel(void (*work)(void *arg), void *arg);
+
+/* PC Speaker */
+
+/* Start playing a tone of hz Hertz. */
+void speaker_on(uint32_t hz);
+
+/* Stop playing. */
+void speaker_off(void);
+
+/* Profiling. When built with -DPROFILE (make PROFILE=1), the code between
+ * PROFILE_BEGIN and PROFILE_END is timed and counted towards a section of the
+ * profile in the debug overlay. Otherwise both compile to nothing. */
+
+#ifdef PROFILE
+
+enum section {
+    SECTION_UPDATE,
+    SECTION_GHOST,
+    SECTION_DRAW,
+    SECTION_CLEAR,
+    SECTION_SCAN,
+    SECTION_FIRMWARE, /* Each console call into the firmware */
+    SECTION_SEARCH,   /* Each autoplayer search */
+    SECTION__LENGTH
+};
+
+/* Count t ticks spent in section. Implemented in game.c. */
+void profile_add(enum section section, uint64_t t);
+
+#define PROFILE_BEGIN(section) uint64_t profile_##section = ticks()
+#define PROFILE_END(section) profile_add(section, ticks() - profile_##section)
+
+#else
+
+#define PROFILE_BEGIN(section)
+#define PROFILE_END(section)
+
+#endif
+
+#endif
@@ -0,0 +1,137 @@
+/*
+ *  UEFI Tetris
+ *  Copyright (C) 2013C2014, Curtis McEnroe programble@gmail.com
+ *
+ *  Permission to use, copy, modify, and/or distribute this software
+ *  for any purpose with or without fee is hereby granted, provided 
+ *  that the above copyright notice and this permission notice
+ *  appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ *  WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL
+ *  THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR 
+ *  CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ *  LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ *  NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ *  CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "platform.h"
+#include "replay.h"
+
+/* A replay is a header followed by the events. Each event is the number of
+ * milliseconds since the event before it and the key, both as unsigned
+ * LEB128 varints: 7 bits per byte, low bits first, with the top bit set on
+ * every byte but the last. Most events take two or three bytes. */
+
+#define REPLAY_MAGIC   "TRPL"
+#define REPLAY_VERSION (2)
+#define REPLAY_SIZE    (256 * 1024)
+
+/* Flags of a replay */
+#define REPLAY_TRUNCATED (1) /* The game went on after the replay was full */
+
+/* Version 1 had no gravity or flags: those replays are played under the
+ * classic rules, whatever is in their place. */
+struct replay_header {
+    char magic[4];
+    uint8_t version, flags;
+    uint16_t gravity;
+    uint32_t seed, score;
+};
+
+uint8_t replay[REPLAY_SIZE];
+uintn_t replay_len = 0, replay_pos = 0;
+uint32_t replay_ms = 0, replay_events = 0;
+bool replay_full = false;
+
+static void put_varint(uint32_t n)
+{
+    while (n >= 0x80) {
+        replay[replay_len++] = n | 0x80;
+        n >>= 7;
+    }
+    replay[replay_len++] = n;
+}
+
+static bool get_varint(uint32_t *n)
+{
+    uint8_t shift = 0, b;
+    *n = 0;
+    do {
+        if (replay_pos == replay_len || shift > 28)
+            return false;
+        b = replay[replay_pos++];
+        *n |= (uint32_t) (b & 0x7F) << shift;
+        shift += 7;
+    } while (b & 0x80);
+    return true;
+}
+
+void replay_start(uint32_t seed, uint16_t gravity)
+{
+    struct replay_header *header = (struct replay_header *) replay;
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, REPLAY_MAGIC, 4);
+    header->version = REPLAY_VERSION;
+    header->seed = seed;
+    header->gravity = gravity;
+    replay_len = sizeof(*header);
+    replay_ms = replay_events = 0;
+    replay_full = false;
+}
+
+void replay_record(uint32_t ms, int key)
+{
+    /* Two varints take at most 10 bytes */
+    if (replay_full || replay_len + 10 > REPLAY_SIZE) {
+        replay_full = true;
+        return;
+    }
+    put_varint(ms - replay_ms);
+    put_varint(key);
+    replay_ms = ms;
+    replay_events++;
+}
+
+uintn_t replay_save(const char *name, uint32_t score)
+{
+    struct replay_header *header = (struct replay_header *) replay;
+    header->score = score;
+    header->flags = replay_full ? REPLAY_TRUNCATED : 0;
+    return file_save(name, replay, replay_len) ? replay_len : 0;
+}
+
+bool replay_load(const char *name, uint32_t *seed, uint16_t *gravity,
+                 uint32_t *score)
+{
+    struct replay_header *header = (struct replay_header *) replay;
+    replay_len = REPLAY_SIZE;
+    if (!file_load(name, replay, &replay_len) ||
+        replay_len < sizeof(*header) ||
+        memcmp(header->magic, REPLAY_MAGIC, 4) ||
+        header->version < 1 || header->version > REPLAY_VERSION) {
+        replay_len = 0;
+        return false;
+    }
+    *seed = header->seed;
+    *gravity = header->version >= 2 ? header->gravity : 0;
+    *score = header->score;
+    replay_full = header->version >= 2 && header->flags & REPLAY_TRUNCATED;
+    replay_pos = sizeof(*header);
+    replay_ms = replay_events = 0;
+    return true;
+}
+
+bool replay_next(uint32_t *ms, int *key)
+{
+    uint32_t delta, k;
+    if (!get_varint(&delta) || !get_varint(&k))
+        return false;
+    replay_ms += delta;
+    *ms = replay_ms;
+    *key = k;
+    replay_events++;
+    return true;
+}
@@ -0,0 +1,69 @@
+/*
+ *  UEFI Tetris
+ *  Copyright (C) 2013C2014, Curtis McEnroe programble@gmail.com
+ *
+ *  Permission to use, copy, modify, and/or distribute this software
+ *  for any purpose with or without fee is hereby granted, provided 
+ *  that the above copyright notice and this permission notice
+ *  appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ *  WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL
+ *  THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR 
+ *  CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ *  LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ *  NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ *  CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "platform.h"
+
+/* Replays: the seed and gravity a game was played with and every key that
+ * changed it, each with the time it was handled at in milliseconds since the
+ * game started, so the same game can be played again. Gravity steps, locking
+ * after the lock delay and clearing full rows, which the main loop does on
+ * its own, are recorded as pseudo-keys. */
+
+/* File the last game is saved to and played back from */
+#define REPLAY_FILE "tetris.rpl"
+
+/* Pseudo-keys, above any key scan() returns */
+#define EVENT_UPDATE (0x10000)
+#define EVENT_CLEAR  (0x10001)
+#define EVENT_LOCK   (0x10002)
+
+/* Start recording a game played with seed and gravity. */
+void replay_start(uint32_t seed, uint16_t gravity);
+
+/* Record key, handled ms milliseconds into the game. Once the replay is full,
+ * nothing more is recorded. */
+void replay_record(uint32_t ms, int key);
+
+/* Save the replay, and the score the game ended with, to the file name,
+ * marked as truncated if it filled up. Return the number of bytes written, or
+ * 0 if it could not be saved. */
+uintn_t replay_save(const char *name, uint32_t score);
+
+/* Load the replay in the file name for playback and set seed, gravity and
+ * score to those it was recorded with. Return false if there is no valid
+ * replay. */
+bool replay_load(const char *name, uint32_t *seed, uint16_t *gravity,
+                 uint32_t *score);
+
+/* Set ms and key to the next event of the loaded replay. Return false if
+ * there are no more. */
+bool replay_next(uint32_t *ms, int *key);
+
+/* Number of events recorded or played back so far */
+extern uint32_t replay_events;
+
+/* Set once the replay being recorded is full, or if the loaded one filled up
+ * while it was recorded: the game went on past its last event, so playback
+ * does not reach the score it was recorded with. */
+extern bool replay_full;
+
+#endif
@@ -0,0 +1,200 @@
+/*
+ *  UEFI Tetris
+ *  Copyright (C) 2013C2014, Curtis McEnroe programble@gmail.com
+ *
+ *  Permission to use, copy, modify, and/or distribute this software
+ *  for any purpose with or without fee is hereby granted, provided 
+ *  that the above copyright notice and this permission notice
+ *  appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ *  WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL
+ *  THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR 
+ *  CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ *  LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ *  NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ *  CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef TETRIS_H
+#define TETRIS_H
+
+/* The game engine: the well, the tetriminos and the rules. Nothing in here
+ * draws, reads the keyboard or knows about time beyond being told to
+ * update(). */
+
+#include "platform.h"
+
+/* Tetris well dimensions */
+#define WELL_WIDTH  (10)
+#define WELL_HEIGHT (22)
+/* Initial interval in milliseconds at which to apply gravity */
+#define INITIAL_SPEED (1000)
+
+/* Gravity, in 1/256 rows per update() as on arcade machines: GRAVITY_UNIT is
+ * one row per update, and GRAVITY_20G or more takes a tetrimino straight to
+ * where it lands, from the moment it spawns. */
+#define GRAVITY_UNIT (256)
+#define GRAVITY_20G  (20 * GRAVITY_UNIT)
+
+/* Bits of the occupancy bitboard (see struct tetris): cell x of a row is bit
+ * x + WALL; the bits on either side of the well and the rows below its floor
+ * are always set, so tetriminos collide with the walls and floor like with
+ * any other cell and a full row is FULL_ROW. */
+#define WALL      (3)
+#define FULL_ROW  (0xFFFF)
+#define EMPTY_ROW ((uint16_t) ~(((1 << WELL_WIDTH) - 1) << WALL))
+
+/* The seven tetriminos, I, J, L, O, S, T and Z, in each of 4 rotations, each
+ * in a 4x4 box. The tables are generated by mkpieces from the shapes in
+ * mkpieces.c into pieces.c, so they are constant data. */
+
+/* Color of each tetrimino */
+extern const uint8_t TETRIS_COLOR[7];
+
+/* A cell of a tetrimino, from the top left of its box */
+struct offset {
+    int8_t x, y;
+};
+
+/* The 4 cells of each tetrimino in each rotation, top down */
+extern const struct offset TETRIS_CELLS[7][4][4];
+
+/* Row masks of each tetrimino in each rotation: bit x of TETRIS_MASK[i][r][y]
+ * is set if there is a cell at x, y. */
+extern const uint16_t TETRIS_MASK[7][4][4];
+
+/* The rows and columns of its box a tetrimino in a rotation has cells in,
+ * inclusive. There are cells in every row and column in between. */
+struct box {
+    int8_t left, top, right, bottom;
+};
+
+extern const struct box TETRIS_BOX[7][4];
+
+/* Top and bottom offsets of each tetrimino in each rotation: the y of the
+ * highest and lowest cell in column x of the box, or -1 if the column is
+ * empty. */
+extern const int8_t TETRIS_TOP[7][4][4];
+extern const int8_t TETRIS_BOTTOM[7][4][4];
+
+/* Zobrist hashing of wells: every cell of the well has a random 64-bit key,
+ * and the hash of a well is the XOR of the keys of its filled cells, so it
+ * can be kept up to date one change at a time. ZOBRIST_ROW holds the XOR of
+ * the keys for every pattern of the left and right half of each row, which
+ * makes the hash of a row two lookups. ZOBRIST_PIECE keys the tetrimino to
+ * be placed next, for hashing a well together with it. Both are generated
+ * into pieces.c by mkpieces. */
+extern const uint64_t ZOBRIST_ROW[WELL_HEIGHT][2][1 << WELL_WIDTH / 2];
+extern const uint64_t ZOBRIST_PIECE[7];
+
+/* Return the hash of the cells of occupancy row y of a well. */
+static inline uint64_t row_hash(uint8_t y, uint16_t row)
+{
+    row = (row & (uint16_t) ~EMPTY_ROW) >> WALL;
+    return ZOBRIST_ROW[y][0][row & ((1 << WELL_WIDTH / 2) - 1)] ^
+           ZOBRIST_ROW[y][1][row >> WELL_WIDTH / 2];
+}
+
+/* When set, ghost() checks the landing row it computes from tops against a
+ * collision scan and counts the disagreements in ghost_errors. */
+extern bool check_ghost;
+
+/* Random numbers, from a PCG32 generator. The same seed always gives the same
+ * numbers. */
+struct rng {
+    uint64_t state, inc;
+};
+
+void rng_seed(struct rng *rng, uint64_t seed);
+uint32_t rng_next(struct rng *rng);
+uint32_t rng_range(struct rng *rng, uint32_t range);
+
+struct current {
+    uint8_t i, r; /* Tetrimino and rotation */
+    uint8_t p;    /* Index into bag of preview tetrimino */
+    int8_t x, y; /* Coordinates */
+    int8_t g;    /* Y-coordinate of ghost */
+};
+
+#define BAG_SIZE (7)
+
+/* Everything about one game. Every engine function takes the game to act on,
+ * and a game holds no pointers, so any number of them can be kept in an
+ * array and a game can be copied with a plain assignment. What the engine
+ * reads on every move comes first. */
+struct tetris {
+    /* Occupancy bitboard of the well, one 16-bit mask per row, kept in step
+     * with well */
+    uint16_t occupancy[WELL_HEIGHT + 4];
+
+    /* Zobrist hash of the well, kept up to date by lock() and clear_rows() */
+    uint64_t hash;
+
+    /* Surface of the well: the y of the top occupied cell of each column, or
+     * WELL_HEIGHT if the column is empty. Kept up to date by lock() and
+     * clear_rows(). */
+    uint8_t tops[WELL_WIDTH];
+
+    struct current current;
+
+    /* Gravity, or 0 for the classic rules: one row per update(), and a
+     * tetrimino that cannot move down locks at the next update(). Under any
+     * other gravity a tetrimino that has landed stays unlocked until
+     * lock_down(), which the game calls after a lock delay. */
+    uint16_t gravity;
+
+    /* Part of a row gravity has moved the current tetrimino by */
+    uint8_t fall;
+
+    /* Shuffled bag of next tetrimino indices */
+    uint8_t bag[BAG_SIZE];
+
+    /* The y-coordinates of the rows cleared in the last update, top down.
+     * Unused entries are -1. */
+    int8_t cleared_rows[4];
+
+    /* Rows cleared in the current level */
+    uint8_t level_rows;
+
+    bool game_over;
+
+    uint32_t score, level, speed, level_up;
+
+    /* Number of tetriminos locked into the well in this game */
+    uint32_t locks;
+
+    /* The generator the tetriminos are drawn with */
+    struct rng rng;
+
+    /* Number of each tetrimino spawned */
+    uint32_t stats[7];
+
+    /* Number of rows checked for being full in this game, and number of
+     * checks a scan of the whole well after every update would have made on
+     * top of that */
+    uint32_t row_checks, row_checks_skipped;
+
+    uint32_t ghost_checks, ghost_errors;
+
+    /* Two-dimensional array of color values */
+    uint8_t well[WELL_HEIGHT][WELL_WIDTH];
+};
+
+void reset(struct tetris *t, uint32_t seed, uint16_t gravity);
+bool collide(const struct tetris *t, uint8_t i, uint8_t r, int8_t x,
+             int8_t y);
+void spawn(struct tetris *t);
+void ghost(struct tetris *t);
+bool move(struct tetris *t, int8_t dx, int8_t dy);
+bool rotate(struct tetris *t);
+void soft_drop(struct tetris *t);
+uint8_t lock(struct tetris *t);
+void update(struct tetris *t);
+bool landed(const struct tetris *t);
+void lock_down(struct tetris *t);
+void clear_rows(struct tetris *t);
+void drop(struct tetris *t);
+
+#endif
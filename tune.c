@@ -0,0 +1,334 @@
+/*
+ *  UEFI Tetris
+ *  Copyright (C) 2013C2014, Curtis McEnroe programble@gmail.com
+ *
+ *  Permission to use, copy, modify, and/or distribute this software
+ *  for any purpose with or without fee is hereby granted, provided 
+ *  that the above copyright notice and this permission notice
+ *  appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ *  WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL
+ *  THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR 
+ *  CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ *  LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ *  NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ *  CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "platform.h"
+#include "tetris.h"
+#include "ai.h"
+
+/* Weight tuning: plays batches of headless games with the autoplayer, for a
+ * number of weight vectors and seeds, on every core, and writes the mean
+ * lines and pieces per game of each weight vector as CSV. Every game is a
+ * struct tetris of its own, played by the same rules as in the game. Built
+ * with make tune. */
+
+#define MAX_THREADS (256)
+#define MAX_VECTORS (4096)
+
+/* Settings, fixed before the threads start */
+uint32_t games = 100, max_pieces = 10000, first_seed = 1;
+bool lookahead = false;
+struct weights vectors[MAX_VECTORS];
+uint32_t vector_count = 0;
+
+/* Outcome of job j, which is game j % games with vectors[j / games] */
+struct result {
+    uint32_t lines, pieces;
+};
+struct result *results;
+uint32_t jobs;
+
+uint64_t tpms = 1000000;
+
+uint64_t ticks(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void *allocate(uintn_t size)
+{
+    return malloc(size);
+}
+
+/* The games are already spread over the cores, so a lookahead search runs
+ * on the thread that asked for it. */
+uint32_t processors(void)
+{
+    return 1;
+}
+
+void parallel(void (*work)(void *arg), void *arg)
+{
+    work(arg);
+}
+
+/* One game */
+
+/* Play a game by the engine's rules until it is over or max_pieces have been
+ * placed, looking ahead with table, the transposition table of the thread, if
+ * asked to. */
+static void play(uint32_t job, struct table *table)
+{
+    const struct weights *w = &vectors[job / games];
+    struct result *r = &results[job];
+    struct tetris game;
+    struct board board;
+    struct placement best;
+    uint8_t i;
+    bool found;
+
+    reset(&game, first_seed + job % games, 0);
+    r->lines = 0;
+    while (!game.game_over && game.locks < max_pieces) {
+        board_load(&board, &game);
+        if (lookahead)
+            found = ai_lookahead(&board, game.current.i,
+                                 game.bag[game.current.p], game.current.y, w,
+                                 false, table, &best);
+        else
+            found = ai_search(&board, game.current.i, game.current.y, w,
+                              &best);
+        if (!found)
+            break;
+        game.current.r = best.r;
+        game.current.x = best.x;
+        drop(&game);
+        for (i = 0; i < 4; i++)
+            r->lines += game.cleared_rows[i] >= 0;
+        if (game.cleared_rows[0] >= 0)
+            clear_rows(&game);
+    }
+    r->pieces = game.locks;
+}
+
+/* Thread pool. Each worker starts with an equal share of the jobs, takes
+ * them from the front of its own range and, once that is empty, steals the
+ * back half of the largest range left. Games with good weights last far
+ * longer than games with bad ones, so the shares end up very uneven. */
+
+struct worker {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    uint32_t next, end; /* Jobs not yet taken */
+    struct table table;
+} __attribute__((aligned(64)));
+
+struct worker workers[MAX_THREADS];
+uint32_t threads;
+
+/* Take the next job of w, or steal some. Return false if there are none
+ * left anywhere. */
+static bool take(struct worker *w, uint32_t *job)
+{
+    struct worker *victim, *largest;
+    uint32_t i, left, most;
+
+    pthread_mutex_lock(&w->lock);
+    if (w->next < w->end) {
+        *job = w->next++;
+        pthread_mutex_unlock(&w->lock);
+        return true;
+    }
+    pthread_mutex_unlock(&w->lock);
+
+    for (;;) {
+        largest = NULL;
+        most = 0;
+        for (i = 0; i < threads; i++) {
+            victim = &workers[i];
+            if (victim == w)
+                continue;
+            pthread_mutex_lock(&victim->lock);
+            left = victim->end - victim->next;
+            pthread_mutex_unlock(&victim->lock);
+            if (left > most) {
+                most = left;
+                largest = victim;
+            }
+        }
+        if (!largest)
+            return false;
+
+        /* It may have been taken from since */
+        pthread_mutex_lock(&largest->lock);
+        left = largest->end - largest->next;
+        if (!left) {
+            pthread_mutex_unlock(&largest->lock);
+            continue;
+        }
+        *job = largest->end - (left + 1) / 2;
+        i = largest->end;
+        largest->end = *job;
+        pthread_mutex_unlock(&largest->lock);
+
+        pthread_mutex_lock(&w->lock);
+        w->next = *job + 1;
+        w->end = i;
+        pthread_mutex_unlock(&w->lock);
+        return true;
+    }
+}
+
+static void *work(void *arg)
+{
+    struct worker *w = arg;
+    uint32_t job;
+    while (take(w, &job))
+        play(job, &w->table);
+    return NULL;
+}
+
+/* Output */
+
+static void write_csv(FILE *f)
+{
+    uint64_t lines, pieces;
+    uint32_t v, g, capped;
+
+    fprintf(f, "height,lines,holes,bumpiness,games,mean_lines,mean_pieces,"
+            "capped\n");
+    for (v = 0; v < vector_count; v++) {
+        lines = pieces = capped = 0;
+        for (g = 0; g < games; g++) {
+            lines += results[v * games + g].lines;
+            pieces += results[v * games + g].pieces;
+            capped += results[v * games + g].pieces == max_pieces;
+        }
+        fprintf(f, "%d,%d,%d,%d,%u,%.2f,%.2f,%u\n", vectors[v].height,
+                vectors[v].lines, vectors[v].holes, vectors[v].bumpiness,
+                games, (double) lines / games, (double) pieces / games,
+                capped);
+    }
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s [-l] [-t threads] [-g games] [-m pieces] [-s seed]\n"
+            "          [-r vectors] [-o file] [height,lines,holes,bumpiness "
+            "...]\n"
+            "  -l  look one tetrimino ahead, like the autoplayer\n"
+            "  -t  number of threads, all cores by default\n"
+            "  -g  games per weight vector, with seeds seed to seed+games-1\n"
+            "  -m  end games that reach this many pieces\n"
+            "  -s  first seed\n"
+            "  -r  add this many random weight vectors around the defaults\n"
+            "  -o  write the CSV to file instead of standard output\n"
+            "Weights start with -, so put -- before them. Without weight\n"
+            "vectors or -r, the default weights are played.\n",
+            name);
+    exit(2);
+}
+
+/* Return w varied by up to half of each weight, either way. */
+static struct weights vary(const struct weights *w, struct rng *rng)
+{
+    struct weights v = *w;
+    v.height += (int32_t) rng_range(rng, 1001) * v.height / 1000 - v.height / 2;
+    v.lines += (int32_t) rng_range(rng, 1001) * v.lines / 1000 - v.lines / 2;
+    v.holes += (int32_t) rng_range(rng, 1001) * v.holes / 1000 - v.holes / 2;
+    v.bumpiness += (int32_t) rng_range(rng, 1001) * v.bumpiness / 1000 -
+                   v.bumpiness / 2;
+    return v;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *output = NULL;
+    uint32_t random_vectors = 0, i, share;
+    struct rng rng;
+    struct weights *w;
+    uint64_t t, pieces = 0;
+    FILE *f = stdout;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int opt;
+
+    threads = cores < 1 ? 1 : cores > MAX_THREADS ? MAX_THREADS : cores;
+    while ((opt = getopt(argc, argv, "lt:g:m:s:r:o:")) != -1) {
+        switch (opt) {
+        case 'l': lookahead = true;                          break;
+        case 't': threads = strtoul(optarg, NULL, 10);       break;
+        case 'g': games = strtoul(optarg, NULL, 10);         break;
+        case 'm': max_pieces = strtoul(optarg, NULL, 10);    break;
+        case 's': first_seed = strtoul(optarg, NULL, 10);    break;
+        case 'r': random_vectors = strtoul(optarg, NULL, 10); break;
+        case 'o': output = optarg;                           break;
+        default:  usage(argv[0]);
+        }
+    }
+    if (!threads || threads > MAX_THREADS || !games || !max_pieces)
+        usage(argv[0]);
+    for (; optind < argc; optind++) {
+        if (vector_count == MAX_VECTORS)
+            usage(argv[0]);
+        w = &vectors[vector_count++];
+        if (sscanf(argv[optind], "%d,%d,%d,%d", &w->height, &w->lines,
+                   &w->holes, &w->bumpiness) != 4)
+            usage(argv[0]);
+    }
+    if (!vector_count && !random_vectors)
+        vectors[vector_count++] = default_weights;
+    rng_seed(&rng, first_seed);
+    for (i = 0; i < random_vectors && vector_count < MAX_VECTORS; i++)
+        vectors[vector_count++] = vary(&default_weights, &rng);
+
+    jobs = vector_count * games;
+    results = calloc(jobs, sizeof(*results));
+    if (!results) {
+        perror("calloc");
+        return 1;
+    }
+    evaluator = evaluator_fastest();
+
+    t = ticks();
+    share = (jobs + threads - 1) / threads;
+    for (i = 0; i < threads; i++) {
+        pthread_mutex_init(&workers[i].lock, NULL);
+        if (lookahead && !table_init(&workers[i].table)) {
+            perror("table_init");
+            return 1;
+        }
+        workers[i].next = i * share < jobs ? i * share : jobs;
+        workers[i].end = (i + 1) * share < jobs ? (i + 1) * share : jobs;
+    }
+    for (i = 1; i < threads; i++)
+        if (pthread_create(&workers[i].thread, NULL, work, &workers[i])) {
+            perror("pthread_create");
+            return 1;
+        }
+    work(&workers[0]);
+    for (i = 1; i < threads; i++)
+        pthread_join(workers[i].thread, NULL);
+    t = ticks() - t;
+
+    for (i = 0; i < jobs; i++)
+        pieces += results[i].pieces;
+    fprintf(stderr, "%u games on %u threads in %.3f s: %.0f games/s, "
+            "%.0f pieces/s\n", jobs, threads, t / 1e9, jobs * 1e9 / t,
+            pieces * 1e9 / t);
+
+    if (output && !(f = fopen(output, "w"))) {
+        perror(output);
+        return 1;
+    }
+    write_csv(f);
+    if (f != stdout && fclose(f)) {
+        perror(output);
+        return 1;
+    }
+    return 0;
+}